@@ -0,0 +1,82 @@
+// Mixed read/write contention benchmarks for ConcurrentConfig.
+//
+// Every thread owns one section it writes to and reads from all sections.
+// range(0) is the percentage of operations that are writes. BM_GlobalLockMixed
+// runs the same workload against a Config behind a single reader/writer lock
+// for comparison.
+
+#include <iniparsercxx_concurrent.hpp>
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+static const int kSections = 64;
+static const int kKeys = 64;
+
+static std::vector<std::string> names(const char *prefix, int n) {
+    std::vector<std::string> out;
+    for (int i = 0; i < n; ++i) out.push_back(prefix + std::to_string(i));
+    return out;
+}
+
+static ConcurrentConfig *g_sharded = nullptr;
+
+static void BM_ShardedMixed(benchmark::State &state) {
+    static const auto sections = names("s", kSections);
+    static const auto keys = names("k", kKeys);
+    if (state.thread_index() == 0) {
+        g_sharded = new ConcurrentConfig();
+        for (const auto &s : sections)
+            for (const auto &k : keys) g_sharded->set(s, k, "value");
+    }
+    const int write_pct = static_cast<int>(state.range(0));
+    const std::string &own = sections[static_cast<size_t>(state.thread_index()) % kSections];
+
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        if (static_cast<int>(i % 100) < write_pct) g_sharded->set(own, keys[i % kKeys], "value");
+        else benchmark::DoNotOptimize(g_sharded->get(sections[i % kSections], keys[(i >> 6) % kKeys]));
+        ++i;
+    }
+
+    if (state.thread_index() == 0) {
+        delete g_sharded;
+        g_sharded = nullptr;
+    }
+}
+BENCHMARK(BM_ShardedMixed)->Arg(0)->Arg(1)->Arg(10)->ThreadRange(1, 8)->UseRealTime();
+
+static Config *g_global = nullptr;
+static std::shared_mutex g_global_mutex;
+
+static void BM_GlobalLockMixed(benchmark::State &state) {
+    static const auto sections = names("s", kSections);
+    static const auto keys = names("k", kKeys);
+    if (state.thread_index() == 0) {
+        g_global = new Config();
+        for (const auto &s : sections)
+            for (const auto &k : keys) g_global->set(s, k, "value");
+    }
+    const int write_pct = static_cast<int>(state.range(0));
+    const std::string &own = sections[static_cast<size_t>(state.thread_index()) % kSections];
+
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        if (static_cast<int>(i % 100) < write_pct) {
+            std::unique_lock<std::shared_mutex> lock(g_global_mutex);
+            g_global->set(own, keys[i % kKeys], "value");
+        } else {
+            std::shared_lock<std::shared_mutex> lock(g_global_mutex);
+            benchmark::DoNotOptimize(g_global->get(sections[i % kSections], keys[(i >> 6) % kKeys]));
+        }
+        ++i;
+    }
+
+    if (state.thread_index() == 0) {
+        delete g_global;
+        g_global = nullptr;
+    }
+}
+BENCHMARK(BM_GlobalLockMixed)->Arg(0)->Arg(1)->Arg(10)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,73 @@
+// Skewed-access lookups in a plain versus a profile-guided ConfigImage.
+//
+// Keys are drawn from a Zipf distribution (s = 1) over 200 x 1000 entries in a
+// shuffled rank order. The profiled image is built from a LookupProfiler run
+// over the same stream, so its hottest entries sit at their first probe
+// position and share cache lines at the front of the entry table and arena.
+
+#include "bench_util.hpp"
+#include <iniparsercxx_image.hpp>
+#include <iniparsercxx_profile.hpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int kSections = 200;
+static const int kKeys = 1000;
+static const size_t kStream = 1 << 16;
+
+struct ZipfSetup {
+    Config cfg;
+    std::vector<std::pair<std::string, std::string>> stream; // lookups in order
+    std::string plain;
+    std::string profiled;
+
+    ZipfSetup() {
+        std::string err;
+        cfg.loadFromFile(writeIniFile("bench_layout.ini", kSections, kKeys), err);
+
+        // rank -> entry, shuffled so popularity is unrelated to file order
+        std::vector<std::pair<std::string, std::string>> entries;
+        for (int s = 0; s < kSections; ++s)
+            for (int k = 0; k < kKeys; ++k) entries.emplace_back("s" + std::to_string(s), "k" + std::to_string(k));
+        std::mt19937_64 rng(42);
+        std::shuffle(entries.begin(), entries.end(), rng);
+
+        std::vector<double> weights(entries.size());
+        for (size_t i = 0; i < weights.size(); ++i) weights[i] = 1.0 / static_cast<double>(i + 1);
+        std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+        for (size_t i = 0; i < kStream; ++i) stream.push_back(entries[zipf(rng)]);
+
+        auto profiler = std::make_shared<LookupProfiler>();
+        cfg.setProfiler(profiler);
+        for (const auto &k : stream) cfg.get(k.first, k.second);
+        cfg.setProfiler(nullptr);
+
+        plain = ConfigImage::build(cfg);
+        profiled = ConfigImage::build(cfg, profiler->report(cfg, 4096).hot);
+    }
+};
+
+static const ZipfSetup &setup() {
+    static ZipfSetup s;
+    return s;
+}
+
+// range(0) != 0 uses the profile-guided image
+static void BM_ZipfFind(benchmark::State &state) {
+    const ZipfSetup &s = setup();
+    const std::string &bytes = state.range(0) ? s.profiled : s.plain;
+    ConfigImage image = ConfigImage::view(bytes.data(), bytes.size());
+    std::string_view value;
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto &k = s.stream[i++ & (kStream - 1)];
+        benchmark::DoNotOptimize(image.find(k.first, k.second, value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ZipfFind)->Arg(0)->Arg(1);
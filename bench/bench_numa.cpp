@@ -0,0 +1,59 @@
+// Lookups through NumaConfig replicas versus a single shared ConfigImage.
+//
+// On multi-socket machines BM_NumaFind reads node-local memory while threads on
+// remote nodes of BM_SharedImageFind cross the interconnect. On one node the
+// difference is the cost of the per-thread cache check.
+
+#include "bench_util.hpp"
+#include <iniparsercxx_numa.hpp>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+static const int kSections = 100;
+static const int kKeys = 100;
+
+static Config generated() {
+    Config cfg;
+    std::string err;
+    cfg.loadFromFile(writeIniFile("bench_numa.ini", kSections, kKeys), err);
+    return cfg;
+}
+
+static std::vector<std::pair<std::string, std::string>> lookups() {
+    std::vector<std::pair<std::string, std::string>> out;
+    for (int i = 0; i < 1024; ++i)
+        out.emplace_back("s" + std::to_string(i * 31 % kSections), "k" + std::to_string(i * 17 % kKeys));
+    return out;
+}
+
+static void BM_NumaFind(benchmark::State &state) {
+    static NumaConfig numa;
+    static const auto keys = lookups();
+    if (state.thread_index() == 0 && numa.generation() == 0) {
+        std::string err;
+        numa.publish(generated(), err);
+    }
+    size_t i = static_cast<size_t>(state.thread_index()) * 97;
+    std::string_view value;
+    for (auto _ : state) {
+        const auto &k = keys[i++ & 1023];
+        benchmark::DoNotOptimize(numa.find(k.first, k.second, value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NumaFind)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SharedImageFind(benchmark::State &state) {
+    static const std::string bytes = ConfigImage::build(generated());
+    static const auto keys = lookups();
+    ConfigImage image = ConfigImage::view(bytes.data(), bytes.size());
+    size_t i = static_cast<size_t>(state.thread_index()) * 97;
+    std::string_view value;
+    for (auto _ : state) {
+        const auto &k = keys[i++ & 1023];
+        benchmark::DoNotOptimize(image.find(k.first, k.second, value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedImageFind)->ThreadRange(1, 8)->UseRealTime();
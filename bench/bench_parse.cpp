@@ -0,0 +1,94 @@
+// Parser and lookup benchmarks for Config.
+
+#include "bench_util.hpp"
+#include <iniparsercxx.hpp>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// Full load of a generated file with range(0) sections of 256 keys
+static void BM_LoadFromFile(benchmark::State &state) {
+    std::string path = writeIniFile("bench_load.ini", static_cast<int>(state.range(0)), 256);
+    Config cfg;
+    std::string err;
+    for (auto _ : state) {
+        if (!cfg.loadFromFile(path, err)) state.SkipWithError(err.c_str());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(makeIniText(static_cast<int>(state.range(0)), 256).size()));
+}
+BENCHMARK(BM_LoadFromFile)->Arg(4)->Arg(64);
+
+// Bounded-memory load of the same files through a 64 KiB read buffer.
+static void BM_LoadBounded(benchmark::State &state) {
+    std::string path = writeIniFile("bench_load.ini", static_cast<int>(state.range(0)), 256);
+    Config cfg;
+    std::string err;
+    ParseLimits limits;
+    for (auto _ : state) {
+        if (!cfg.loadFromFile(path, err, limits)) state.SkipWithError(err.c_str());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(makeIniText(static_cast<int>(state.range(0)), 256).size()));
+}
+BENCHMARK(BM_LoadBounded)->Arg(4)->Arg(64);
+
+// Strict load of the same (clean) files; should cost the same as BM_LoadFromFile.
+static void BM_LoadStrict(benchmark::State &state) {
+    std::string path = writeIniFile("bench_load.ini", static_cast<int>(state.range(0)), 256);
+    Config cfg;
+    std::string err;
+    for (auto _ : state) {
+        if (!cfg.loadStrict(path, err)) state.SkipWithError(err.c_str());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(makeIniText(static_cast<int>(state.range(0)), 256).size()));
+}
+BENCHMARK(BM_LoadStrict)->Arg(4)->Arg(64);
+
+// Lookup of existing keys spread over all sections.
+// range(0) != 0 enables the lookup cache; the key set is larger than the cache,
+// so this is the miss-heavy case.
+static void BM_Get(benchmark::State &state) {
+    std::string path = writeIniFile("bench_get.ini", 64, 256);
+    Config cfg;
+    std::string err;
+    cfg.loadFromFile(path, err);
+    cfg.enableLookupCache(state.range(0) != 0);
+    std::string sections[64], keys[256];
+    for (int i = 0; i < 64; ++i) sections[i] = "s" + std::to_string(i);
+    for (int i = 0; i < 256; ++i) keys[i] = "k" + std::to_string(i);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cfg.get(sections[i % 64], keys[(i * 7) % 256]));
+        ++i;
+    }
+}
+BENCHMARK(BM_Get)->Arg(0)->Arg(1);
+
+// Repeated lookups of range(1) hot keys, with (range(0) != 0) and without the lookup cache
+static void BM_GetHot(benchmark::State &state) {
+    std::string path = writeIniFile("bench_get.ini", 64, 256);
+    Config cfg;
+    std::string err;
+    cfg.loadFromFile(path, err);
+    cfg.enableLookupCache(state.range(0) != 0);
+    const int hot = static_cast<int>(state.range(1));
+    std::vector<std::string> sections, keys;
+    for (int i = 0; i < hot; ++i) {
+        sections.push_back("s" + std::to_string(i * 13 % 64));
+        keys.push_back("k" + std::to_string(i * 29 % 256));
+    }
+
+    Config::resetLookupCacheStats();
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t k = i++ % static_cast<size_t>(hot);
+        benchmark::DoNotOptimize(cfg.get(sections[k], keys[k]));
+    }
+    Config::LookupCacheStats stats = Config::lookupCacheStats();
+    if (stats.hits + stats.misses)
+        state.counters["hit_rate"] = static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+}
+BENCHMARK(BM_GetHot)->ArgsProduct({{0, 1}, {8, 64}});
@@ -0,0 +1,54 @@
+// Read scaling of a shared const Config: get() copies the value (and allocates
+// for values longer than the small-string buffer), find() does not.
+
+#include <iniparsercxx.hpp>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+static const int kSections = 64;
+static const int kKeys = 64;
+
+static const Config &sharedConfig() {
+    static const Config config = [] {
+        Config c;
+        for (int s = 0; s < kSections; ++s)
+            for (int k = 0; k < kKeys; ++k)
+                c.set("s" + std::to_string(s), "k" + std::to_string(k),
+                      "a value longer than the small string buffer " + std::to_string(s * kKeys + k));
+        return c;
+    }();
+    return config;
+}
+
+static std::vector<std::string> names(const char *prefix, int n) {
+    std::vector<std::string> out;
+    for (int i = 0; i < n; ++i) out.push_back(prefix + std::to_string(i));
+    return out;
+}
+
+static void BM_SharedConstGet(benchmark::State &state) {
+    static const auto sections = names("s", kSections);
+    static const auto keys = names("k", kKeys);
+    const Config &config = sharedConfig();
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.get(sections[i % kSections], keys[(i >> 6) % kKeys]));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedConstGet)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_SharedConstFind(benchmark::State &state) {
+    static const auto sections = names("s", kSections);
+    static const auto keys = names("k", kKeys);
+    const Config &config = sharedConfig();
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.find(sections[i % kSections], keys[(i >> 6) % kKeys]));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedConstFind)->ThreadRange(1, 64)->UseRealTime();
@@ -0,0 +1,106 @@
+// Latency and throughput of ConfigServer lookups over a Unix socket.
+//
+// BM_ServerGet is one key per round trip (latency), BM_ServerBatch looks up
+// range(0) keys per round trip and BM_ServerPipelined keeps range(0) single-key
+// requests in flight. Items per second is the lookup throughput.
+
+#include "bench_util.hpp"
+#include <iniparsercxx_server.hpp>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// Server over a generated 100 x 100 config, started once per process.
+struct BenchServer {
+    BenchServer() : path("bench_server_" + std::to_string(::getpid()) + ".sock") {
+        std::string err;
+        Config cfg;
+        cfg.loadFromFile(writeIniFile("bench_server.ini", 100, 100), err);
+        server.publish(cfg, err);
+        server.listen(path, err);
+        thread = std::thread([this] {
+            std::string run_err;
+            server.run(run_err);
+        });
+    }
+    ~BenchServer() {
+        server.stop();
+        thread.join();
+    }
+
+    ConfigServer server;
+    std::string path;
+    std::thread thread;
+};
+
+const std::string &serverPath() {
+    static BenchServer server;
+    return server.path;
+}
+
+std::vector<ConfigClient::Key> keys(size_t n) {
+    std::vector<ConfigClient::Key> out;
+    for (size_t i = 0; i < n; ++i) out.emplace_back("s" + std::to_string(i % 100), "k" + std::to_string(i * 7 % 100));
+    return out;
+}
+
+} // namespace
+
+static void BM_ServerGet(benchmark::State &state) {
+    ConfigClient client;
+    std::string err;
+    if (!client.connect(serverPath(), err)) {
+        state.SkipWithError(err.c_str());
+        return;
+    }
+    auto batch = keys(1);
+    ConfigClient::Values values;
+    for (auto _ : state) {
+        client.get(batch, values, err);
+        benchmark::DoNotOptimize(values);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ServerGet)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ServerBatch(benchmark::State &state) {
+    ConfigClient client;
+    std::string err;
+    if (!client.connect(serverPath(), err)) {
+        state.SkipWithError(err.c_str());
+        return;
+    }
+    auto batch = keys(static_cast<size_t>(state.range(0)));
+    ConfigClient::Values values;
+    for (auto _ : state) {
+        client.get(batch, values, err);
+        benchmark::DoNotOptimize(values);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ServerBatch)->Arg(8)->Arg(64)->Arg(512);
+
+static void BM_ServerPipelined(benchmark::State &state) {
+    ConfigClient client;
+    std::string err;
+    if (!client.connect(serverPath(), err)) {
+        state.SkipWithError(err.c_str());
+        return;
+    }
+    auto batch = keys(1);
+    ConfigClient::Values values;
+    const int depth = static_cast<int>(state.range(0));
+    uint32_t id;
+    for (auto _ : state) {
+        for (int i = 0; i < depth; ++i) client.send(batch, id, err);
+        for (int i = 0; i < depth; ++i) client.receive(id, values, err);
+        benchmark::DoNotOptimize(values);
+    }
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_ServerPipelined)->Arg(8)->Arg(64);
@@ -0,0 +1,21 @@
+#pragma once
+#include <fstream>
+#include <string>
+
+// Generate INI text with the given number of sections and keys per section.
+// Sections are named s0, s1, ... and keys k0, k1, ...
+inline std::string makeIniText(int sections, int keys) {
+    std::string text;
+    for (int s = 0; s < sections; ++s) {
+        text += "[s" + std::to_string(s) + "]\n";
+        for (int k = 0; k < keys; ++k)
+            text += "k" + std::to_string(k) + " = value_" + std::to_string(s) + "_" + std::to_string(k) + " ; comment\n";
+    }
+    return text;
+}
+
+// Write generated INI text to path and return the path.
+inline std::string writeIniFile(const std::string &path, int sections, int keys) {
+    std::ofstream(path, std::ios::binary) << makeIniText(sections, keys);
+    return path;
+}
@@ -0,0 +1,50 @@
+// Serializer throughput benchmarks.
+//
+// BM_OstreamWrite is the ad-hoc ostream loop tools used before saveToFile
+// existed and serves as the baseline.
+
+#include "bench_util.hpp"
+#include <iniparsercxx.hpp>
+#include <benchmark/benchmark.h>
+#include <fstream>
+
+static Config makeConfig(int sections) {
+    Config cfg;
+    std::string err;
+    cfg.loadFromFile(writeIniFile("bench_write.ini", sections, 256), err);
+    return cfg;
+}
+
+static void BM_Serialize(benchmark::State &state) {
+    Config cfg = makeConfig(static_cast<int>(state.range(0)));
+    std::string out;
+    for (auto _ : state) {
+        cfg.serialize(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(out.size()));
+}
+BENCHMARK(BM_Serialize)->Arg(64)->Arg(1024);
+
+static void BM_SaveToFile(benchmark::State &state) {
+    Config cfg = makeConfig(static_cast<int>(state.range(0)));
+    std::string err;
+    for (auto _ : state) {
+        if (!cfg.saveToFile("bench_saved.ini", err)) state.SkipWithError(err.c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(cfg.serializedSize()));
+}
+BENCHMARK(BM_SaveToFile)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void BM_OstreamWrite(benchmark::State &state) {
+    Config cfg = makeConfig(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        std::ofstream ofs("bench_ostream.ini");
+        for (const std::string &name : cfg.sections()) {
+            ofs << "[" << name << "]" << std::endl;
+            for (const auto &kv : *cfg.section(name)) ofs << kv.first << "=" << kv.second << std::endl;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(cfg.serializedSize()));
+}
+BENCHMARK(BM_OstreamWrite)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Run iniparsercxx_bench and compare the results against a stored baseline.
+
+The baseline (bench/baseline.json) lists the benchmarks that are gated, their
+median time in nanoseconds and an optional per-benchmark tolerance:
+
+    {
+      "default_tolerance": 0.10,
+      "benchmarks": {
+        "BM_Get/0": {"time_ns": 41.5},
+        "BM_LoadFromFile/64": {"time_ns": 2.1e6, "tolerance": 0.15}
+      }
+    }
+
+A benchmark regresses when its median time exceeds time_ns * (1 + tolerance).
+The script exits with status 1 on any regression or missing benchmark.
+
+To reduce noise the benchmark runs pinned to one CPU, is repeated and only
+medians are compared; a warning is printed when the CPU frequency governor is
+not "performance". Record a new baseline on the reference machine with
+--update (per-benchmark tolerances are kept).
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+
+UNIT_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def warn(msg):
+    print("warning: " + msg, file=sys.stderr)
+
+
+def check_governor():
+    governors = set()
+    for path in glob.glob("/sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_governor"):
+        try:
+            with open(path) as f:
+                governors.add(f.read().strip())
+        except OSError:
+            pass
+    if governors and governors != {"performance"}:
+        warn("CPU frequency governor is %s, not 'performance'; results will be noisy. "
+             "Try: sudo cpupower frequency-set --governor performance" % "/".join(sorted(governors)))
+
+
+def pin(cpu):
+    if not hasattr(os, "sched_setaffinity"):
+        warn("CPU pinning is not supported on this platform")
+        return
+    allowed = sorted(os.sched_getaffinity(0))
+    if cpu is None:
+        cpu = allowed[-1]  # the last CPU is the least likely to handle interrupts
+    if cpu not in allowed:
+        warn("CPU %d is not available, running unpinned" % cpu)
+        return
+    os.sched_setaffinity(0, {cpu})  # inherited by the benchmark process
+    print("pinned to CPU %d" % cpu)
+
+
+def run(bench, out, repetitions, pattern):
+    cmd = [bench,
+           "--benchmark_out=" + out,
+           "--benchmark_out_format=json",
+           "--benchmark_repetitions=%d" % repetitions,
+           "--benchmark_report_aggregates_only=true"]
+    if pattern:
+        cmd.append("--benchmark_filter=" + pattern)
+    print(" ".join(cmd))
+    subprocess.run(cmd, check=True)
+    with open(out) as f:
+        return json.load(f)
+
+
+def medians(results):
+    times = {}
+    for b in results.get("benchmarks", []):
+        if b.get("aggregate_name") != "median":
+            continue
+        times[b["run_name"]] = b["real_time"] * UNIT_NS[b.get("time_unit", "ns")]
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--bench", required=True, help="path to iniparsercxx_bench")
+    parser.add_argument("--baseline", required=True, help="baseline JSON file")
+    parser.add_argument("--out", default="bench_results.json", help="where to write the raw results")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--cpu", type=int, help="CPU to pin to (default: the last allowed CPU)")
+    parser.add_argument("--build-type", default="", help="CMake build type, to warn about unoptimized builds")
+    parser.add_argument("--update", action="store_true", help="record the results as the new baseline")
+    parser.add_argument("--filter", help="regex of benchmarks to run, and with --update to record "
+                                         "(default: the baseline's)")
+    args = parser.parse_args()
+
+    if args.build_type not in ("Release", "RelWithDebInfo"):
+        warn("benchmarks are built as '%s'; compare optimized builds only" % (args.build_type or "no build type"))
+    check_governor()
+    pin(args.cpu)
+
+    baseline = {"default_tolerance": 0.10, "benchmarks": {}}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    gated = baseline.get("benchmarks", {})
+
+    pattern = args.filter or "^(%s)$" % "|".join(re.escape(n) for n in gated)
+    current = medians(run(args.bench, args.out, args.repetitions, pattern))
+
+    if args.update:
+        updated = {}
+        for name, time_ns in sorted(current.items()):
+            if not args.filter and name not in gated:
+                continue
+            entry = {"time_ns": round(time_ns, 2)}
+            if "tolerance" in gated.get(name, {}):
+                entry["tolerance"] = gated[name]["tolerance"]
+            updated[name] = entry
+        baseline["benchmarks"] = updated
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("recorded %d benchmarks in %s" % (len(updated), args.baseline))
+        return 0
+
+    default_tolerance = baseline.get("default_tolerance", 0.10)
+    failed = []
+    print("\n%-40s %14s %14s %9s %8s" % ("benchmark", "baseline ns", "current ns", "change", "limit"))
+    for name, entry in sorted(gated.items()):
+        tolerance = entry.get("tolerance", default_tolerance)
+        if name not in current:
+            print("%-40s %14.1f %14s %9s %8s  MISSING" % (name, entry["time_ns"], "-", "-", "-"))
+            failed.append(name)
+            continue
+        change = current[name] / entry["time_ns"] - 1.0
+        status = "REGRESSION" if change > tolerance else ""
+        print("%-40s %14.1f %14.1f %+8.1f%% %+7.0f%%  %s" % (
+            name, entry["time_ns"], current[name], change * 100, tolerance * 100, status))
+        if status:
+            failed.append(name)
+
+    if failed:
+        print("\n%d of %d benchmarks regressed or are missing" % (len(failed), len(gated)))
+        return 1
+    print("\nall %d benchmarks within tolerance" % len(gated))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,18 +1,395 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class ConfigMetrics;
+class LookupProfiler;
+
+// One unit of parsed INI input, as produced by IniReader.
+// Views point into the reader's buffer and stay valid as long as the reader does.
+struct IniEvent {
+    enum class Kind {
+        Section,   // [section] header; section holds the new name
+        KeyValue,  // key=value line inside section
+        Malformed  // non-comment line without '='; value holds the trimmed line
+    };
+
+    Kind kind = Kind::Malformed;
+    std::string_view section; // current section, "" before any header
+    std::string_view key;
+    std::string_view value;
+    size_t line = 0;          // 1-based line number
+};
+
+// Pull parser over INI text. Yields one IniEvent per section header, entry or
+// malformed line, using the same tokenizer as Config::loadFromFile.
+// Work is done on demand, so callers can stop as soon as they found what they need.
+class IniReader {
+public:
+    IniReader() = default;
+
+    // Read from a caller-owned buffer; the buffer must outlive the reader.
+    explicit IniReader(std::string_view buffer) : buf_(buffer) {}
+
+    // Read from a file. Returns false on failure and sets err.
+    bool open(const std::string &path, std::string &err);
+
+    // Advance to the next event. Returns false at end of input.
+    bool next(IniEvent &ev);
+
+    // Single-pass iterator over the remaining events.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = IniEvent;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const IniEvent *;
+        using reference = const IniEvent &;
+
+        iterator() = default;
+        explicit iterator(IniReader *reader) : reader_(reader) { ++*this; }
+
+        reference operator*() const { return ev_; }
+        pointer operator->() const { return &ev_; }
+        iterator &operator++() {
+            if (!reader_->next(ev_)) reader_ = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator &o) const { return reader_ == o.reader_; }
+        bool operator!=(const iterator &o) const { return reader_ != o.reader_; }
+
+    private:
+        IniReader *reader_ = nullptr;
+        IniEvent ev_;
+    };
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+    // Lines and bytes consumed so far; the input's totals once next() returned false.
+    size_t lines() const { return line_; }
+    size_t bytes() const { return pos_; }
+
+private:
+    std::shared_ptr<const char> file_; // owns the file contents when opened from a path
+    std::string_view buf_;
+    size_t pos_ = 0;
+    size_t line_ = 0;
+    std::string_view section_;
+};
+
+// Selects the sections Config::loadFromFile keeps, either by name or by predicate.
+// "" stands for the top-level section. Any callable taking the section name and
+// returning bool converts implicitly, so a lambda can be passed directly.
+class SectionFilter {
+public:
+    SectionFilter(std::initializer_list<std::string> names) : names_(names) {}
+    SectionFilter(std::unordered_set<std::string> names) : names_(std::move(names)) {}
+    template <class Pred, class = std::enable_if_t<std::is_invocable_r_v<bool, const Pred &, std::string_view>>>
+    SectionFilter(Pred pred) : pred_(std::move(pred)) {}
+
+    bool operator()(std::string_view section) const;
+
+private:
+    std::unordered_set<std::string> names_;
+    std::function<bool(std::string_view)> pred_;
+};
+
+// One problem found by Config::loadStrict, stored as a code and a byte offset
+// into the input; see IniDiagnostics for line and column.
+struct IniDiagnostic {
+    enum class Code : uint8_t {
+        MissingEquals,       // line is not a header, entry or comment
+        EmptyKey,            // "= value"
+        EmptySectionName,    // "[]"
+        UnterminatedSection, // "[section" without the closing ']'
+        DuplicateKey         // key already set in this section block
+    };
+
+    uint64_t offset = 0; // byte offset of the problem in the input
+    Code code = Code::MissingEquals;
+};
+
+// Problems found by Config::loadStrict, in input order. Only offsets are
+// recorded while parsing; if there are any, their lines and columns are
+// resolved in one scan before loadStrict returns, so the diagnostics hold no
+// reference to the input and stay correct if the file changes afterwards.
+class IniDiagnostics {
+    friend class Config;
+
+public:
+    // 1-based line and column (in bytes) of a diagnostic.
+    struct Position {
+        size_t line = 0;
+        size_t column = 0;
+    };
+
+    size_t size() const { return list_.size(); }
+    bool empty() const { return list_.empty(); }
+    const IniDiagnostic &operator[](size_t i) const { return list_[i]; }
+
+    // True if loading stopped at max_errors, so the input may contain more problems.
+    bool stoppedEarly() const { return stopped_; }
+
+    // Position of diagnostic i.
+    Position position(size_t i) const { return positions_[i]; }
+
+    // Positions of all diagnostics.
+    const std::vector<Position> &positions() const { return positions_; }
+
+    // "path:line:column: message" for diagnostic i.
+    std::string format(size_t i) const;
+
+    // All diagnostics, one formatted line each.
+    std::string toString() const;
+
+    static const char *message(IniDiagnostic::Code code);
+
+private:
+    void resolve(std::string_view buf);
+
+    std::string path_;
+    std::vector<IniDiagnostic> list_;
+    std::vector<Position> positions_; // parallel to list_
+    bool stopped_ = false;
+};
+
+// Bounds for streaming loads (Config::loadFromStream and the ParseLimits
+// overload of loadFromFile). Input is read through one buffer of buffer_size
+// bytes, and a load fails as soon as a limit is exceeded. 0 disables a limit.
+struct ParseLimits {
+    size_t max_line_length = 64 * 1024;      // bytes per line, without the '\n'
+    uint64_t max_total_bytes = 1ull << 30;   // bytes of input
+    size_t buffer_size = 64 * 1024;          // read block size; 0 selects the default
+};
 
 class Config {
+    friend class IniPushParser;
+    friend class ConcurrentConfig;
+    friend class CompressedFile;
 
 public:
+    using Section = std::unordered_map<std::string, std::string>;
+
+    // Hit and miss counts of a thread's lookup cache, see enableLookupCache().
+    struct LookupCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
     Config() = default;
+    Config(const Config &) = default;
+    Config(Config &&other) noexcept;
+    Config &operator=(const Config &other);
+    Config &operator=(Config &&other) noexcept;
+    ~Config();
 
     // Load INI file. Returns false on failure and sets err.
     bool loadFromFile(const std::string &path, std::string &err);
 
+    // Load only the sections accepted by filter. Lines of other sections are
+    // skipped by the tokenizer without building strings or map entries, so
+    // malformed lines are only counted in the sections that are loaded.
+    bool loadFromFile(const std::string &path, std::string &err, const SectionFilter &filter);
+
+    // Load INI file strictly: lines that are not a section header, entry or
+    // comment, empty keys or section names, and keys set twice in one section
+    // block are errors instead of being skipped or overwritten; repeated blocks
+    // of a section merge as in loadFromFile. Loading stops after
+    // max_errors problems (0 collects all). On any problem the config is left
+    // empty, err is the first problem as "path:line:column: message" and, if
+    // given, diagnostics receive all problems found. The checks only run on the
+    // lines that fail them, so a clean file loads as fast as with loadFromFile.
+    // Returns false on failure and sets err.
+    bool loadStrict(const std::string &path, std::string &err, size_t max_errors = 1,
+                    IniDiagnostics *diagnostics = nullptr);
+
+    // Load INI file lazily: only section header offsets are recorded up front and
+    // the file stays mapped. Each section is parsed the first time get() or
+    // section() touches it; concurrent first touches are safe.
+    // Files up to 1 MiB are copied instead. A larger file must not be truncated
+    // or rewritten in place (e.g. by IniDocument::save's same-length path) while
+    // this Config or a copy of it is alive: replace it by rename, as saveToFile does.
+    // Returns false on failure and sets err.
+    bool loadLazy(const std::string &path, std::string &err);
+
+    // Supplies the next block of input: copies at most size bytes into buf and
+    // sets got, with got == 0 at end of input. Returns false on failure and sets err.
+    using BlockReader = std::function<bool(char *buf, size_t size, size_t &got, std::string &err)>;
+
+    // Load INI text that arrives block by block, e.g. from a decompressor (see
+    // CompressedFile). Each block is tokenized as it arrives, so besides the
+    // parsed entries only one block and an unfinished line are held in memory.
+    // Returns false on failure, including input beyond limits, and sets err.
+    bool loadFromStream(const BlockReader &read, std::string &err, const ParseLimits &limits = ParseLimits());
+
+    // Load INI file through a fixed-size read buffer with bounded memory instead
+    // of mapping it whole. A file larger than limits.max_total_bytes is rejected
+    // before reading. Returns false on failure and sets err.
+    bool loadFromFile(const std::string &path, std::string &err, const ParseLimits &limits);
+
+    // Reload path unless it is unchanged (same size and modification time) since
+    // the last reloadIfChanged() of this config and the config was not modified
+    // in between. Sets reloaded accordingly. Returns false on failure and sets err.
+    bool reloadIfChanged(const std::string &path, bool &reloaded, std::string &err);
+
     // Get value from [section] key, return default_val if not present.
     std::string get(const std::string &section, const std::string &key, const std::string &default_val = "") const;
 
+    // Find [section] key without copying the value; nullptr if not present.
+    // The pointer stays valid until the config is modified, reloaded or destroyed.
+    // Prefer this over get() on hot paths read by many threads: it does not
+    // allocate, so readers do not contend in the allocator.
+    const std::string *find(const std::string &section, const std::string &key) const;
+
+    // Serve get() through a small direct-mapped cache per thread, so repeated
+    // lookups with the same section and key strings skip hashing and both map
+    // probes. Any change to a cached
+    // config (load, set, erase, assignment, destruction) bumps a global
+    // generation that invalidates all cache entries. Off by default; configs
+    // with the cache off never touch the generation.
+    void enableLookupCache(bool enabled = true);
+
+    // Cache statistics of the calling thread, summed over all configs.
+    static LookupCacheStats lookupCacheStats();
+    static void resetLookupCacheStats();
+
+    // Report every get() to profiler (see iniparsercxx_profile.hpp); nullptr
+    // detaches. Copies of this config share the profiler.
+    void setProfiler(std::shared_ptr<LookupProfiler> profiler);
+    const std::shared_ptr<LookupProfiler> &profiler() const { return profiler_; }
+
+    // Count loads and lookups in metrics (see iniparsercxx_metrics.hpp); nullptr
+    // detaches. Copies of this config share the metrics.
+    void setMetrics(std::shared_ptr<ConfigMetrics> metrics);
+    const std::shared_ptr<ConfigMetrics> &metrics() const { return metrics_; }
+
+    // Read a single value from a file without loading it.
+    // Non-matching sections are skipped without tokenizing their entries.
+    // With last_wins (the loadFromFile semantics) the whole file is scanned;
+    // otherwise the scan stops at the first match.
+    // Returns true and sets value if found. Returns false if the key is absent,
+    // or if the file cannot be read, in which case err is set.
+    static bool peek(const std::string &path, const std::string &section, const std::string &key,
+                     std::string &value, std::string &err, bool last_wins = true);
+
+    // Entries of [name], or nullptr if the section has no entries.
+    const Section *section(const std::string &name) const;
+
+    // Names of all sections that have entries, in no particular order.
+    // In lazy mode this parses every section.
+    std::vector<std::string> sections() const;
+
+    // Set [section] key to value.
+    // Storage is shared between copies of a Config (copying is O(1)); a write
+    // copies only the section it touches if that section is still shared.
+    void set(const std::string &section, const std::string &key, const std::string &value);
+
+    // Remove [section] key. Returns true if the key existed.
+    bool erase(const std::string &section, const std::string &key);
+
+    // Exact number of bytes serialize() produces.
+    size_t serializedSize() const;
+
+    // Render the config as INI text: top-level keys first, then one block per
+    // section, as key=value lines. Order within a section is unspecified.
+    // Entries for which canSerialize() is false are written verbatim and will
+    // not read back the same.
+    void serialize(std::string &out) const;
+
+    // Write serialized text into buf, which must hold serializedSize() bytes.
+    // Returns the number of bytes written.
+    size_t serialize(char *buf) const;
+
+    // Write the config to path atomically and durably: the text goes to a unique
+    // temporary file in the same directory that keeps an existing file's mode and
+    // owner, is fsynced and renamed over path, and the directory is fsynced.
+    // Returns false on failure and sets err.
+    bool saveToFile(const std::string &path, std::string &err) const;
+
+    // True if the entry reads back unchanged after serialize(): no line breaks,
+    // no surrounding whitespace, no '=' in the key, no comment markers in the value.
+    static bool canSerialize(const std::string &section, const std::string &key, const std::string &value);
+
 private:
-    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> data_;
-};
\ No newline at end of file
+    struct LazyIndex;
+    struct FileStamp {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        bool valid = false;
+    };
+    using SectionTable = std::unordered_map<std::string, std::shared_ptr<Section>>;
+
+    bool loadBlocks(const BlockReader &read, std::string &err, const ParseLimits &limits, const std::string &name);
+
+    // Copy-on-write access for writers: unshares the table and the named section.
+    SectionTable &mutableTable();
+    Section &mutableSection(const std::string &name);
+
+    const std::string *find(const std::string &section, const std::string &key, const void *call_site) const;
+    // Uncached lookup; nullptr if absent.
+    const std::string *lookup(const std::string &section, const std::string &key) const;
+    const std::string *cachedLookup(const std::string &section, const std::string &key) const;
+    void invalidateLookupCache() const;
+
+    std::shared_ptr<SectionTable> data_; // shared by copies until one of them writes
+    std::shared_ptr<LazyIndex> lazy_;    // set in lazy mode instead of data_
+    bool cache_ = false;                 // get() goes through the per-thread lookup cache
+    std::shared_ptr<LookupProfiler> profiler_;
+    std::shared_ptr<ConfigMetrics> metrics_;
+    FileStamp stamp_; // file the config was last reloaded from, see reloadIfChanged()
+};
+
+// Resumable push parser for input that arrives in arbitrary chunks (e.g. from a socket).
+// Complete lines are parsed and indexed as soon as they arrive; only the trailing
+// partial line is buffered, so memory is bounded by the longest line, or by
+// max_line_length when it is set.
+class IniPushParser {
+    friend class Config;
+
+public:
+    IniPushParser() = default;
+
+    // Stop at the first line longer than max_line_length bytes (0 = no limit).
+    explicit IniPushParser(size_t max_line_length) : max_line_(max_line_length) {}
+
+    // Parse all complete lines in chunk and keep any trailing partial line.
+    // Input after an overlong line is ignored.
+    void feed(std::string_view chunk);
+
+    // 1-based number of the first line longer than max_line_length, 0 if none.
+    size_t overlongLine() const { return overlong_; }
+
+    // Parse the remaining partial line as the last line, return the built config
+    // and reset the parser for new input.
+    Config finish();
+
+    // Number of lines parsed so far.
+    size_t lines() const { return line_; }
+
+private:
+    void parse(std::string_view line);
+    bool tooLong(size_t len);
+
+    Config config_;
+    std::string partial_;  // bytes of the current line not yet terminated by '\n'
+    std::string section_;  // current section name
+    Config::Section *current_ = nullptr;
+    size_t line_ = 0;
+    size_t keys_ = 0;      // entry and malformed lines, for Config::loadFromStream's metrics
+    size_t malformed_ = 0;
+    size_t max_line_ = 0;
+    size_t overlong_ = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Block reader over a possibly compressed INI file. The format is detected from
+// the magic bytes, and the data is decompressed one block at a time straight
+// into Config::loadFromStream, without a temporary file or a buffer holding
+// the whole decompressed text. gzip needs zlib and zstd needs libzstd at build
+// time; see supported(). Plain files are passed through unchanged.
+class CompressedFile {
+public:
+    enum class Format { Plain, Gzip, Zstd };
+
+    CompressedFile();
+    ~CompressedFile();
+
+    CompressedFile(const CompressedFile &) = delete;
+    CompressedFile &operator=(const CompressedFile &) = delete;
+
+    // Open path and detect its format. Fails for formats this build cannot
+    // decompress. Returns false on failure and sets err.
+    bool open(const std::string &path, std::string &err);
+
+    // Decompress up to size bytes into buf and set got, with got == 0 at the
+    // end of the data. Concatenated gzip members and zstd frames are read in
+    // sequence. Returns false on failure (e.g. truncated or corrupt input) and sets err.
+    bool read(char *buf, size_t size, size_t &got, std::string &err);
+
+    // Format of the open file.
+    Format format() const { return format_; }
+
+    // Bytes read from the file so far.
+    uint64_t compressedBytes() const { return compressed_bytes_; }
+
+    // Load path into cfg, decompressing it on the fly if needed. limits apply
+    // to the decompressed text, which bounds the damage of a compression bomb.
+    // Returns false on failure and sets err.
+    static bool load(Config &cfg, const std::string &path, std::string &err, const ParseLimits &limits = ParseLimits());
+
+    // Format of data that starts with head.
+    static Format detect(std::string_view head);
+
+    // True if this build can read format.
+    static bool supported(Format format);
+
+private:
+    struct Decoder; // zlib or zstd stream state, defined in the .cpp
+
+    bool fill(std::string &err);
+
+    std::string path_;
+    std::FILE *file_ = nullptr;
+    Format format_ = Format::Plain;
+    std::unique_ptr<char[]> in_; // compressed input block
+    size_t in_pos_ = 0;
+    size_t in_len_ = 0;
+    bool eof_ = false;
+    uint64_t compressed_bytes_ = 0;
+    std::unique_ptr<Decoder> decoder_;
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include <array>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Thread-safe mutable config for processes that change keys at runtime while
+// other threads keep reading. Sections are spread over hash-selected shards,
+// each behind its own reader/writer lock, so a write only blocks readers of
+// sections in the same shard.
+class ConcurrentConfig {
+public:
+    // Batch of set/erase operations applied as one atomic step by commit().
+    // snapshot() sees either none or all of a committed batch.
+    class Transaction {
+    public:
+        void set(const std::string &section, const std::string &key, const std::string &value);
+        void erase(const std::string &section, const std::string &key);
+
+        // Number of staged operations.
+        size_t size() const { return ops_.size(); }
+
+        // Apply the staged operations in order and clear them. Locks only the
+        // shards the batch touches and copies only the sections it writes to,
+        // so the cost is the batch size plus the size of those sections; other
+        // sections keep their identity. All or nothing: the operations are
+        // applied to the copies, which are swapped in only once all succeeded.
+        // If an exception escapes, the config and the staged operations are
+        // unchanged.
+        void commit();
+
+    private:
+        friend class ConcurrentConfig;
+        explicit Transaction(ConcurrentConfig &owner) : owner_(&owner) {}
+
+        struct Op {
+            std::string section;
+            std::string key;
+            std::string value;
+            bool erase;
+        };
+
+        ConcurrentConfig *owner_;
+        std::vector<Op> ops_;
+    };
+
+    ConcurrentConfig() = default;
+    explicit ConcurrentConfig(const Config &cfg) { reset(cfg); }
+
+    ConcurrentConfig(const ConcurrentConfig &) = delete;
+    ConcurrentConfig &operator=(const ConcurrentConfig &) = delete;
+
+    // Load INI file and replace all contents. Returns false on failure and sets err;
+    // the current contents are kept in that case.
+    bool loadFromFile(const std::string &path, std::string &err);
+
+    // Replace all contents with cfg.
+    void reset(const Config &cfg);
+
+    // Get value from [section] key, return default_val if not present.
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "") const;
+
+    // Set [section] key to value.
+    void set(const std::string &section, const std::string &key, const std::string &value);
+
+    // Remove [section] key. Returns true if the key existed.
+    bool erase(const std::string &section, const std::string &key);
+
+    // Start a batch of changes to this config.
+    Transaction transaction() { return Transaction(*this); }
+
+    // Consistent copy of all contents. Sections are shared with the snapshot and
+    // copied by the next write that touches them.
+    Config snapshot() const;
+
+private:
+    static constexpr size_t kShards = 16;
+
+    using Sections = std::unordered_map<std::string, std::shared_ptr<Config::Section>>;
+
+    // One cache line per shard so neighbouring locks do not share a line.
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Sections sections;
+    };
+
+    static size_t shardIndex(const std::string &section);
+    Shard &shardFor(const std::string &section) const { return shards_[shardIndex(section)]; }
+
+    // Writes to a shard's table whose lock the caller holds exclusively.
+    // Sections referenced elsewhere are copied first.
+    static void setLocked(Sections &sections, const std::string &section, const std::string &key,
+                          const std::string &value);
+    static bool eraseLocked(Sections &sections, const std::string &section, const std::string &key);
+
+    mutable std::array<Shard, kShards> shards_;
+};
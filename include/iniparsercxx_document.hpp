@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lossless, editable view of an INI file.
+// The source text is kept as is together with the byte ranges of every section
+// header, key and value. Edits are recorded against those ranges and applied by
+// splicing only the affected bytes into the output, so comments, blank lines,
+// ordering and spacing survive untouched.
+class IniDocument {
+public:
+    IniDocument() = default;
+
+    // Load and index a file. Returns false on failure and sets err.
+    bool load(const std::string &path, std::string &err);
+
+    // Index text held in memory.
+    void parse(std::string text);
+
+    // Get value from [section] key (last occurrence wins, as in Config).
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "") const;
+
+    // Replace the value of [section] key in place, or add key=value after the
+    // last entry of the section (a new section is appended at the end).
+    // Returns false, leaving the document unchanged, if the entry would not read
+    // back as written (see Config::canSerialize; ']' is rejected everywhere).
+    bool set(const std::string &section, const std::string &key, const std::string &value);
+
+    // Remove every line defining [section] key. Returns true if the key existed.
+    bool erase(const std::string &section, const std::string &key);
+
+    // Number of pending edits not yet saved.
+    size_t pendingEdits() const;
+
+    // Source text with all edits applied.
+    std::string text() const;
+
+    // Write the document to path.
+    // If path is the loaded file, it is unchanged on disk, and every edit
+    // replaces a value with one of the same length, only the edited byte ranges
+    // are written in place. Otherwise the file is replaced atomically and durably
+    // like Config::saveToFile.
+    // Returns false on failure and sets err.
+    bool save(const std::string &path, std::string &err);
+
+private:
+    struct Entry {
+        size_t section;              // index into sections_
+        size_t line_begin, line_end; // whole line including its '\n'
+        size_t val_begin, val_end;   // value without inline comment and spaces
+        std::string value;           // current value
+        std::string key;             // only kept for entries added by set()
+        bool original = true;        // false for entries added by set()
+        bool erased = false;
+    };
+    struct Section {
+        std::string name;
+        size_t index = 0;     // position in sections_
+        bool in_source = false;
+        size_t insert_at = 0; // where new keys of the section go
+        std::unordered_map<std::string, std::vector<size_t>> keys; // key -> entries, last one wins
+    };
+    struct Splice {
+        size_t begin, end;
+        std::string text;
+    };
+
+    const Entry *find(const std::string &section, const std::string &key) const;
+    Section &sectionFor(const std::string &name);
+    std::vector<Splice> splices() const;
+
+    std::string src_;
+    std::string path_;      // file the document was loaded from
+    size_t file_size_ = 0;  // and its size and mtime at that point
+    long long file_mtime_ = 0;
+    std::vector<Entry> entries_;
+    std::vector<Section> sections_;
+    std::unordered_map<std::string, size_t> section_index_;
+};
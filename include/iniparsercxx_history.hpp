@@ -0,0 +1,57 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+// In-memory history of the last N versions of a config, for rollback and auditing.
+// Versions are stored in a persistent hash array mapped trie (section -> key -> value)
+// with structural sharing: a new version only allocates the trie paths to entries
+// that changed, and any retained version answers lookups in O(log n).
+class ConfigHistory {
+public:
+    // Keep at most max_versions versions; older ones are dropped on commit.
+    explicit ConfigHistory(size_t max_versions = 16);
+    ~ConfigHistory();
+
+    ConfigHistory(const ConfigHistory &) = delete;
+    ConfigHistory &operator=(const ConfigHistory &) = delete;
+
+    // Record cfg as the newest version and return its version number.
+    // Version numbers start at 1 and increase by one per commit.
+    uint64_t commit(const Config &cfg);
+
+    // Number of retained versions.
+    size_t size() const { return versions_.size(); }
+
+    // Newest and oldest retained version numbers, 0 if nothing was committed.
+    uint64_t latest() const;
+    uint64_t oldest() const;
+
+    // True if version is still retained.
+    bool contains(uint64_t version) const;
+
+    // Get value from [section] key as of version; default_val if the key or
+    // the version is not present.
+    std::string get(uint64_t version, const std::string &section, const std::string &key,
+                    const std::string &default_val = "") const;
+
+    // Rebuild the full config of a version, e.g. to roll back to it.
+    // Returns false if the version is not retained.
+    bool checkout(uint64_t version, Config &out) const;
+
+    // Number of distinct trie nodes and entries alive across all versions.
+    // Reflects the memory held by the history.
+    size_t nodeCount() const;
+
+private:
+    struct Version; // defined in the .cpp
+
+    const Version *find(uint64_t version) const;
+
+    size_t max_versions_;
+    uint64_t next_ = 1;
+    std::deque<std::shared_ptr<const Version>> versions_;
+    Config last_; // last committed config; its section pointers identify unchanged sections
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include "iniparsercxx_profile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compiled, immutable form of a Config in one contiguous byte buffer: a header,
+// an open-addressing hash index and a string arena, linked by offsets only.
+// Because it holds no pointers, an image can be copied or mapped anywhere
+// (shared memory, node-local memory) and read in place.
+//
+// ConfigImage itself is a non-owning view; whoever maps or allocates the bytes
+// keeps them alive.
+class ConfigImage {
+public:
+    ConfigImage() = default;
+
+    // Compile cfg into image bytes. Returns an empty string if the image would
+    // exceed 4 GiB.
+    static std::string build(const Config &cfg);
+
+    // Profile-guided build: the entries in hot, most read first (e.g.
+    // LookupProfiler::report(cfg, n).hot), get their first probe position and are
+    // packed together at the front of the entry table and the string arena, so
+    // the hottest lookups touch the fewest cache lines.
+    static std::string build(const Config &cfg, const std::vector<LookupProfiler::KeyCount> &hot);
+
+    // View over image bytes. Returns an invalid view if the header does not
+    // describe an image of exactly size bytes. Contents are trusted beyond that.
+    static ConfigImage view(const void *data, size_t size);
+
+    bool valid() const { return data_ != nullptr; }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Number of entries.
+    size_t entries() const;
+
+    // Find [section] key. On success value points into the image.
+    bool find(std::string_view section, std::string_view key, std::string_view &value) const;
+
+    // Get value from [section] key, return default_val if not present.
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "") const;
+
+private:
+    ConfigImage(const char *data, size_t size) : data_(data), size_(size) {}
+
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
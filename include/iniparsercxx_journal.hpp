@@ -0,0 +1,74 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+// Config with persistent runtime overrides.
+// Changes are appended to a journal file next to the INI file (path + ".journal")
+// at O(1) cost instead of rewriting the INI file. Opening replays the journal
+// over the parsed file. Once the records appended since the last compaction
+// pass a threshold, a background thread folds them back into the INI file,
+// keeping its comments and layout.
+class JournaledConfig {
+public:
+    // Compact in the background once more than compact_threshold bytes of records
+    // were appended since the last compaction; 0 disables automatic compaction.
+    explicit JournaledConfig(size_t compact_threshold = 1 << 20);
+    ~JournaledConfig();
+
+    JournaledConfig(const JournaledConfig &) = delete;
+    JournaledConfig &operator=(const JournaledConfig &) = delete;
+
+    // Load the INI file, replay its journal and open the journal for appending.
+    // A missing journal is created. Returns false on failure and sets err.
+    bool open(const std::string &path, std::string &err);
+
+    // Get value from [section] key, return default_val if not present.
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "") const;
+
+    // Set or remove a value and append the change to the journal.
+    // Returns false and sets err if the journal write fails; memory is unchanged then.
+    bool set(const std::string &section, const std::string &key, const std::string &value, std::string &err);
+    bool erase(const std::string &section, const std::string &key, std::string &err);
+
+    // Fold the journal into the INI file now, editing only the entries that
+    // changed. Returns false on failure and sets err.
+    bool compact(std::string &err);
+
+    // Current contents, sharing storage with this object.
+    Config snapshot() const;
+
+    // Size of the journal file in bytes.
+    size_t journalSize() const;
+
+    // Error of the last failed background compaction, empty if none.
+    std::string lastCompactError() const;
+
+private:
+    bool append(char op, const std::string &section, const std::string &key, const std::string &value,
+                std::string &err);
+    void compactLoop();
+    void close();
+
+    size_t threshold_;
+    std::string path_;
+    std::string journal_path_;
+    int fd_ = -1;
+    size_t journal_size_ = 0;
+    size_t compacted_size_ = 0; // journal size after the last compaction (records it kept)
+
+    mutable std::shared_mutex mutex_; // guards config_, fd_, journal_size_ and compacted_size_
+    Config config_;
+
+    std::mutex compact_mutex_;        // serializes compactions
+    mutable std::mutex wake_mutex_;  // guards the fields below
+    std::condition_variable wake_;
+    bool compact_requested_ = false;
+    bool stop_ = false;
+    std::string compact_error_;
+    std::thread worker_;
+};
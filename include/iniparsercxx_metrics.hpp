@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Counters for config loads and lookups, exported in the Prometheus text format.
+// Attach to a Config with Config::setMetrics(). Counting is lock-free and never
+// allocates: counters are striped over cache-line sized slots, each thread adds
+// to its own stripe and render() sums the stripes.
+class ConfigMetrics {
+public:
+    // labels is inserted into every sample, e.g. config="service" (no braces).
+    explicit ConfigMetrics(std::string labels = "");
+
+    ConfigMetrics(const ConfigMetrics &) = delete;
+    ConfigMetrics &operator=(const ConfigMetrics &) = delete;
+
+    // Called by Config.
+    void recordLoad(bool ok, uint64_t nanoseconds, uint64_t bytes, uint64_t keys, uint64_t malformed);
+    void recordGet(bool hit);
+    void recordSkippedReload();
+
+    struct Totals {
+        uint64_t loads = 0;
+        uint64_t load_failures = 0;
+        uint64_t load_nanoseconds = 0;
+        uint64_t bytes = 0;
+        uint64_t keys = 0;
+        uint64_t malformed = 0;
+        uint64_t gets = 0;
+        uint64_t misses = 0;
+        uint64_t reloads_skipped = 0;
+    };
+
+    // Current counter values summed over all stripes.
+    Totals totals() const;
+
+    // Write the metrics as Prometheus exposition text into buf, which holds size
+    // bytes; the output is NUL-terminated if size > 0. Returns the length of the
+    // full text like snprintf, so a result >= size means buf was too small.
+    size_t render(char *buf, size_t size) const;
+
+    // Upper bounds of the load duration histogram buckets in seconds (+Inf is implicit).
+    static const double kBuckets[];
+    static const size_t kBucketCount = 7;
+
+private:
+    enum Counter {
+        kLoads,
+        kLoadFailures,
+        kLoadNanoseconds,
+        kBytes,
+        kKeys,
+        kMalformed,
+        kGets,
+        kMisses,
+        kReloadsSkipped,
+        kBucket0, // one counter per histogram bucket follows
+        kCounterCount = kBucket0 + kBucketCount
+    };
+
+    static const size_t kStripes = 16;
+
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> counters[kCounterCount];
+    };
+
+    Stripe &local();
+    uint64_t sum(size_t counter) const;
+
+    std::string labels_;
+    Stripe stripes_[kStripes];
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "iniparsercxx_image.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-mostly config replicated per NUMA node. publish() compiles the config
+// into a ConfigImage and places one copy in the memory of every node, so each
+// thread reads from its local node instead of taking cross-socket misses.
+// Without libnuma, or on single-node machines, there is a single replica.
+//
+// A thread is routed to the replica of the node it runs on when it first reads
+// after a publish; pin reader threads for stable placement. Each thread caches
+// its replica for a few instances at once, so the steady-state cost of a lookup
+// over ConfigImage::find is one atomic load. The replicas belong to the
+// instance: threads only hold weak references, and destroying a NumaConfig
+// frees them whether or not reader threads are still alive.
+class NumaConfig {
+public:
+    NumaConfig();
+    ~NumaConfig();
+
+    NumaConfig(const NumaConfig &) = delete;
+    NumaConfig &operator=(const NumaConfig &) = delete;
+
+    // Replace the config on all nodes. Every replica is written before the new
+    // set is published, so readers see either the old or the new config on
+    // every node. hot optionally orders the layout, see ConfigImage::build.
+    // Returns false on failure and sets err.
+    bool publish(const Config &cfg, std::string &err, const std::vector<LookupProfiler::KeyCount> &hot = {});
+
+    // Find [section] key in the calling thread's replica. value stays valid
+    // until this thread reads again after a later publish(), reads from more
+    // than kThreadSlots other instances, or the instance is destroyed.
+    bool find(std::string_view section, std::string_view key, std::string_view &value) const;
+
+    // Get value from [section] key, return default_val if not present.
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "") const;
+
+    // Number of replicas of the current config, 0 before the first publish.
+    size_t replicas() const;
+
+    // Generation of the last publish, 0 before the first.
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    // True if NUMA placement is supported on this machine.
+    static bool numaAvailable();
+
+    // Number of instances each thread caches a replica for.
+    static constexpr size_t kThreadSlots = 4;
+
+private:
+    // defined in the .cpp
+    struct ReplicaSet;
+    struct State;       // current and retired sets and the threads reading them
+    struct ThreadCache; // per-thread slots, one per recently read instance
+
+    const ConfigImage &local() const;
+    static ThreadCache &threadCache();
+
+    const uint64_t id_; // distinguishes instances in the per-thread cache
+    std::atomic<uint64_t> generation_{0};
+    std::shared_ptr<State> state_;
+};
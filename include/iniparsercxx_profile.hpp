@@ -0,0 +1,68 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Opt-in sampling profiler for Config::get(): which keys are read most, which
+// lookups miss and fall back to defaults, which keys are never read, and where
+// get() is called from. Attach it with Config::setProfiler().
+//
+// Counting happens in per-thread shards owned by the profiler, so sampled
+// lookups on different threads never share a cache line and never lock;
+// report() merges the shards. A shard holds up to 4096 distinct keys and 256
+// call sites; samples beyond that are counted in Report::dropped.
+class LookupProfiler {
+public:
+    struct KeyCount {
+        std::string section;
+        std::string key;
+        uint64_t count;
+    };
+    struct CallSite {
+        const void *address; // return address into the caller of get(); symbolize with addr2line or gdb
+        uint64_t count;
+    };
+    struct Report {
+        uint64_t lookups = 0;                // estimated total, samples x sample rate
+        std::vector<KeyCount> hot;           // most read keys that exist
+        std::vector<KeyCount> misses;        // most read keys that do not exist
+        std::vector<std::pair<std::string, std::string>> unread; // entries of the config never sampled
+        std::vector<CallSite> call_sites;    // busiest callers of get()
+        uint64_t dropped = 0;                // samples of keys or call sites beyond the shard capacity
+
+        // Human-readable summary.
+        std::string toString() const;
+    };
+
+    // Record every sample_every-th lookup per thread; 1 records all of them.
+    explicit LookupProfiler(unsigned sample_every = 1);
+    ~LookupProfiler();
+
+    LookupProfiler(const LookupProfiler &) = delete;
+    LookupProfiler &operator=(const LookupProfiler &) = delete;
+
+    // Record one lookup; called by Config::get().
+    void record(const std::string &section, const std::string &key, bool hit, const void *call_site);
+
+    // Merge all threads' counts. Counts are scaled by the sample rate. unread
+    // lists entries of cfg that no sampled lookup touched.
+    Report report(const Config &cfg, size_t top_n = 10) const;
+
+    // Clear all counts. Samples recorded concurrently may survive the reset.
+    void reset();
+
+private:
+    struct Shard; // defined in the .cpp
+
+    Shard &localShard();
+
+    const uint64_t id_; // distinguishes instances in the per-thread shard cache; never reused
+    const unsigned sample_every_;
+    mutable std::mutex mutex_; // guards shards_
+    std::vector<std::shared_ptr<Shard>> shards_;
+};
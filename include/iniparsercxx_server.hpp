@@ -0,0 +1,114 @@
+#pragma once
+#include "iniparsercxx.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Host-local config daemon over a Unix domain socket, for short-lived processes
+// that cannot afford to parse the config themselves.
+//
+// Wire format: every frame is a 32-bit length (of the rest of the frame), a
+// one-byte op and a 32-bit request id, followed by the op's payload. All
+// integers are little endian. See iniparsercxx_server.cpp for the ops.
+// A client may send any number of requests before reading the answers
+// (pipelining); answers come back in request order.
+
+// Serves lookups from the most recently published config. run() is a single
+// threaded poll loop; publish() and stop() may be called from other threads.
+class ConfigServer {
+public:
+    ConfigServer();
+    ~ConfigServer();
+
+    ConfigServer(const ConfigServer &) = delete;
+    ConfigServer &operator=(const ConfigServer &) = delete;
+
+    // Bind and listen on socket_path, replacing a stale socket file. The socket
+    // file gets mode (0600 by default, only the server's user may connect)
+    // before it accepts connections. Returns false on failure and sets err.
+    bool listen(const std::string &socket_path, std::string &err, unsigned mode = 0600);
+
+    // Make cfg the config answered from and notify subscribers of the new
+    // generation. Returns false on failure and sets err.
+    bool publish(const Config &cfg, std::string &err);
+
+    // Generation of the last publish, 0 before the first.
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    // Serve clients until stop() is called. Returns false on failure and sets err.
+    bool run(std::string &err);
+
+    // Make run() return. Safe to call from a signal handler.
+    void stop();
+
+private:
+    struct Connection; // defined in the .cpp
+
+    void wake();
+    void handle(Connection &conn, const std::string &image, uint64_t generation);
+
+    int listen_fd_ = -1;
+    int wake_fds_[2] = {-1, -1};
+    std::string path_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> generation_{0};
+    std::mutex mutex_;                         // guards image_
+    std::shared_ptr<const std::string> image_; // ConfigImage bytes of the current generation
+    std::vector<std::unique_ptr<Connection>> connections_;
+};
+
+// Client for ConfigServer. One connection, not thread-safe.
+class ConfigClient {
+public:
+    using Key = std::pair<std::string, std::string>; // section, key
+    using Values = std::vector<std::optional<std::string>>;
+
+    ConfigClient() = default;
+    ~ConfigClient();
+
+    ConfigClient(const ConfigClient &) = delete;
+    ConfigClient &operator=(const ConfigClient &) = delete;
+
+    // Connect to a server. Returns false on failure and sets err.
+    bool connect(const std::string &socket_path, std::string &err);
+    void close();
+
+    // Look up all keys in one round trip; values[i] is empty if keys[i] is absent.
+    // All values come from the same generation. Returns false on failure and sets err.
+    bool get(const std::vector<Key> &keys, Values &values, std::string &err);
+
+    // Get value from [section] key, return default_val if not present or on error.
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "");
+
+    // Pipelining: send() queues a batch and returns its request id without
+    // waiting; receive() returns the next answer in request order.
+    // get() and subscribe() must not be called while answers are outstanding.
+    bool send(const std::vector<Key> &keys, uint32_t &id, std::string &err);
+    bool receive(uint32_t &id, Values &values, std::string &err);
+
+    // Ask the server to push an event on every publish. Returns false on failure and sets err.
+    bool subscribe(std::string &err);
+
+    // Wait for the next reload event and return its generation. timeout_ms < 0
+    // waits forever. Returns false on timeout (err left empty) or failure (err set).
+    bool waitReload(uint64_t &generation, std::string &err, int timeout_ms = -1);
+
+    // Generation the last answer or reload event came from.
+    uint64_t generation() const { return generation_; }
+
+private:
+    bool readFrame(char &op, uint32_t &id, std::string &payload, std::string &err, int timeout_ms);
+    bool readAnswer(char expected, uint32_t &id, std::string &payload, std::string &err);
+
+    int fd_ = -1;
+    uint32_t next_id_ = 1;
+    uint64_t generation_ = 0;
+    std::string in_;               // received bytes not yet consumed
+    std::deque<uint64_t> reloads_; // reload events received while waiting for answers
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "iniparsercxx_image.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Host-wide config sharing through POSIX shared memory.
+// One process parses the config and publishes it as a ConfigImage; any number
+// of processes map it read-only, so the host holds one parsed copy.
+//
+// name is a shared memory object name such as "/myservice-config". It names a
+// small control segment holding the current generation; each published version
+// lives in its own segment (name + "." + generation). Publishing writes the new
+// segment completely before bumping the generation, so readers switch versions
+// with a single atomic load and never take a lock.
+//
+// Segments are created with mode (0600 by default, so only the publisher's
+// user can read them); pass e.g. 0640 or 0644 to share with other users.
+class SharedConfigPublisher {
+public:
+    explicit SharedConfigPublisher(std::string name, unsigned mode = 0600);
+    ~SharedConfigPublisher();
+
+    SharedConfigPublisher(const SharedConfigPublisher &) = delete;
+    SharedConfigPublisher &operator=(const SharedConfigPublisher &) = delete;
+
+    // Publish cfg as the next generation. The previous generation's segment is
+    // unlinked; readers that still map it keep a valid view until they switch.
+    // hot optionally orders the layout, see ConfigImage::build.
+    // Returns false on failure and sets err.
+    bool publish(const Config &cfg, std::string &err, const std::vector<LookupProfiler::KeyCount> &hot = {});
+
+    // Generation of the last publish, 0 before the first.
+    uint64_t generation() const { return generation_; }
+
+    // Remove the control segment and the current generation's segment.
+    static void remove(const std::string &name);
+
+private:
+    bool openControl(std::string &err);
+
+    std::string name_;
+    unsigned mode_;
+    void *control_ = nullptr;
+    uint64_t generation_ = 0;
+};
+
+// Read-only view of a published config. A reader is meant to be used by one
+// thread; create one per thread that reads.
+class SharedConfigReader {
+public:
+    explicit SharedConfigReader(std::string name);
+    ~SharedConfigReader();
+
+    SharedConfigReader(const SharedConfigReader &) = delete;
+    SharedConfigReader &operator=(const SharedConfigReader &) = delete;
+
+    // Map the current generation. Returns false if nothing is published yet and sets err.
+    bool attach(std::string &err);
+
+    // Switch to the newest generation if it changed. Returns true if it switched.
+    // Called by get() and find(); costs one atomic load when nothing changed.
+    bool refresh();
+
+    // Get value from [section] key, return default_val if not present.
+    std::string get(const std::string &section, const std::string &key, const std::string &default_val = "");
+
+    // Find [section] key. value stays valid until the reader switches generation.
+    bool find(std::string_view section, std::string_view key, std::string_view &value);
+
+    // Generation currently mapped, 0 if none.
+    uint64_t generation() const { return generation_; }
+
+private:
+    bool map(uint64_t generation);
+    void unmap();
+
+    std::string name_;
+    void *control_ = nullptr;
+    void *data_ = nullptr;
+    size_t size_ = 0;
+    uint64_t generation_ = 0;
+    ConfigImage image_;
+};
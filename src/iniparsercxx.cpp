@@ -9,17 +9,58 @@
 // - get(section, key, default_val):
 //     Returns the configured value or default_val if not found.
 //
-// The parser stores data in an unordered_map<string, unordered_map<string,string>>
+// The parser stores data in an unordered_map<string, shared_ptr<unordered_map<string,string>>>
 // where outer map keys are section names and inner map keys are keys within the section.
+// Both levels are shared between copies of a Config and copied on write
+// (mutableTable/mutableSection), so cloning is O(1) and an edit copies one section.
+// In lazy mode (loadLazy) the map is replaced by a LazyIndex of section byte ranges
+// over the mapped file, and sections are parsed on first access.
+// With enableLookupCache(), get() first checks a thread-local direct-mapped cache
+// of value pointers, validated by a process-wide generation counter.
+//
+// All parsing goes through parseLine(), which classifies a single line without
+// allocating. IniReader drives it over a whole buffer and loadFromFile consumes
+// the reader's events.
 
 #include "iniparsercxx.hpp"
-#include <fstream>
-#include <sstream>
+#include "iniparsercxx_file.hpp"
+#include "iniparsercxx_metrics.hpp"
+#include "iniparsercxx_probes.hpp"
+#include "iniparsercxx_profile.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define INIPARSERCXX_NO_MMAP 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Return address of the current function, i.e. a location in its caller.
+#if defined(__GNUC__) || defined(__clang__)
+#define INIPARSERCXX_CALLER() __builtin_return_address(0)
+#else
+#define INIPARSERCXX_CALLER() nullptr
+#endif
+
 // Trim whitespace from both ends of a string.
 // Uses unsigned char cast for correct behaviour with negative char values.
-static inline std::string trim(const std::string &s) {
+static inline std::string_view trim(std::string_view s) {
     size_t b = 0;
     size_t e = s.size();
     // advance b until first non-space
@@ -29,72 +70,1141 @@ static inline std::string trim(const std::string &s) {
     return s.substr(b, e - b);
 }
 
-// Load INI-style config file.
-// - path: path to INI file
-// - err: output error message on failure
-// Returns true on success, false on failure.
-bool Config::loadFromFile(const std::string &path, std::string &err) {
-    data_.clear();
+// Result of tokenizing one line.
+enum class LineKind { Blank, Comment, Section, KeyValue, Malformed };
+
+// Classify one line (without its trailing '\n').
+// - Section: a holds the trimmed section name.
+// - KeyValue: a holds the key, b the value with any inline comment removed.
+// - Malformed: a holds the trimmed line.
+static LineKind parseLine(std::string_view line, std::string_view &a, std::string_view &b) {
+    std::string_view s = trim(line);
+    if (s.empty()) return LineKind::Blank;                    // skip blank lines
+    if (s[0] == ';' || s[0] == '#') return LineKind::Comment; // skip full-line comments
+
+    // Section header: [section-name]
+    if (s.front() == '[' && s.back() == ']') {
+        a = trim(s.substr(1, s.size() - 2));
+        return LineKind::Section;
+    }
 
-    // open file stream
-    std::ifstream ifs(path);
+    // Expect key=value pairs. If no '=' present, the line is malformed.
+    auto eq = s.find('=');
+    if (eq == std::string_view::npos) {
+        a = s;
+        return LineKind::Malformed;
+    }
+
+    // Extract key and value, trimming both sides.
+    a = trim(s.substr(0, eq));
+    std::string_view val = s.substr(eq + 1);
+
+    // Remove inline comments from the value (e.g., "value ; comment" or "value # comment").
+    // The earliest occurrence of either ';' or '#' starts the comment.
+    auto cpos = val.find_first_of(";#");
+    if (cpos != std::string_view::npos) val = val.substr(0, cpos);
+    b = trim(val);
+    return LineKind::KeyValue;
+}
+
+#ifndef INIPARSERCXX_NO_MMAP
+// Read fd to its end into a heap buffer; hint is the expected size, if known.
+static bool readAll(int fd, size_t hint, std::shared_ptr<const char> &data, size_t &size) {
+    size_t cap = hint ? hint + 1 : 64 * 1024; // one spare byte to see EOF without regrowing
+    std::unique_ptr<char[]> buf(new char[cap]);
+    size = 0;
+    for (;;) {
+        if (size == cap) {
+            std::unique_ptr<char[]> bigger(new char[cap * 2]);
+            std::memcpy(bigger.get(), buf.get(), size);
+            buf = std::move(bigger);
+            cap *= 2;
+        }
+        ssize_t n = ::read(fd, buf.get() + size, cap - size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        if (n == 0) break;
+        size += static_cast<size_t>(n);
+    }
+    data = std::shared_ptr<const char>(buf.release(), std::default_delete<const char[]>());
+    return true;
+}
+#endif
+
+// Read a whole file into memory owned by a shared_ptr.
+// Regular files larger than copy_limit bytes are mapped read-only, so untouched
+// pages are never read; the mapping faults (SIGBUS) if the file is truncated
+// while it is in use. Smaller files and pipes, character devices or process
+// substitutions, which cannot be mapped, are read into a buffer.
+static bool readFile(const std::string &path, std::shared_ptr<const char> &data, size_t &size, std::string &err,
+                     size_t copy_limit = 0) {
+#ifndef INIPARSERCXX_NO_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        err = "Could not open config file: " + path;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        err = "Could not read config file: " + path;
+        return false;
+    }
+    if (!S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) <= copy_limit) {
+        bool ok = readAll(fd, S_ISREG(st.st_mode) ? static_cast<size_t>(st.st_size) : 0, data, size);
+        ::close(fd);
+        if (!ok) err = "Could not read config file: " + path;
+        return ok;
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        data.reset();
+        return true;
+    }
+    void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err = "Could not map config file: " + path;
+        return false;
+    }
+    size_t len = size;
+    data = std::shared_ptr<const char>(static_cast<const char *>(p), [len](const char *q) {
+        ::munmap(const_cast<char *>(q), len);
+    });
+    return true;
+#else
+    (void)copy_limit;
+    std::ifstream ifs(path, std::ios::binary);
     if (!ifs) {
-        // provide useful error message to caller
         err = "Could not open config file: " + path;
         return false;
     }
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    std::string contents = ss.str();
+    size = contents.size();
+    char *buf = new char[size ? size : 1];
+    std::memcpy(buf, contents.data(), size);
+    data = std::shared_ptr<const char>(buf, std::default_delete<const char[]>());
+    return true;
+#endif
+}
 
-    std::string line;
-    std::string current_section; // holds current [section] name; empty string for top-level (no section)
-    size_t lineno = 0;
-    // Read file line by line to preserve simple parser semantics and better error reporting if needed.
-    while (std::getline(ifs, line)) {
-        ++lineno;
-        std::string s = trim(line);
-        if (s.empty()) continue;                // skip blank lines
-        if (s[0] == ';' || s[0] == '#') continue; // skip full-line comments
+// Open a file for event reading.
+// - path: path to INI file
+// - err: output error message on failure
+// Returns true on success, false on failure.
+bool IniReader::open(const std::string &path, std::string &err) {
+    size_t size = 0;
+    if (!readFile(path, file_, size, err)) return false;
+    buf_ = std::string_view(file_.get(), size);
+    pos_ = 0;
+    line_ = 0;
+    section_ = std::string_view();
+    return true;
+}
 
-        // Section header: [section-name]
-        if (s.front() == '[' && s.back() == ']') {
-            current_section = trim(s.substr(1, s.size() - 2));
+// Advance to the next section header, entry or malformed line.
+// Blank lines and comments are consumed silently.
+bool IniReader::next(IniEvent &ev) {
+    while (pos_ < buf_.size()) {
+        const char *start = buf_.data() + pos_;
+        size_t rest = buf_.size() - pos_;
+        const char *nl = static_cast<const char *>(std::memchr(start, '\n', rest));
+        size_t len = nl ? static_cast<size_t>(nl - start) : rest;
+        pos_ += nl ? len + 1 : len;
+        ++line_;
+
+        std::string_view a, b;
+        switch (parseLine(std::string_view(start, len), a, b)) {
+        case LineKind::Blank:
+        case LineKind::Comment:
             continue;
+        case LineKind::Section:
+            section_ = a;
+            ev.kind = IniEvent::Kind::Section;
+            ev.key = ev.value = std::string_view();
+            break;
+        case LineKind::KeyValue:
+            ev.kind = IniEvent::Kind::KeyValue;
+            ev.key = a;
+            ev.value = b;
+            break;
+        case LineKind::Malformed:
+            ev.kind = IniEvent::Kind::Malformed;
+            ev.key = std::string_view();
+            ev.value = a;
+            break;
         }
+        ev.section = section_;
+        ev.line = line_;
+        return true;
+    }
+    return false;
+}
 
-        // Expect key=value pairs. If no '=' present, ignore the line (for robustness).
-        auto eq = s.find('=');
-        if (eq == std::string::npos) {
+// Check a section name against the filter.
+bool SectionFilter::operator()(std::string_view section) const {
+    if (pred_) return pred_(section);
+    return names_.count(std::string(section)) != 0;
+}
+
+// Section index for lazy mode.
+// The section table is built once by the pre-scan and never changes afterwards;
+// each slot's entries are filled exactly once under its once_flag.
+struct Config::LazyIndex {
+    struct Slot {
+        std::vector<std::pair<size_t, size_t>> ranges; // [begin, end) of each body of the section
+        std::once_flag once;
+        Section entries;
+    };
+
+    std::shared_ptr<const char> file;
+    std::string_view buf;
+    std::unordered_map<std::string, std::unique_ptr<Slot>> sections;
+
+    // Return the parsed entries of a section, parsing it on first use.
+    const Section *find(const std::string &name) const {
+        auto it = sections.find(name);
+        if (it == sections.end()) return nullptr;
+        Slot &slot = *it->second;
+        std::call_once(slot.once, [&] {
+            for (const auto &r : slot.ranges) {
+                IniReader reader(buf.substr(r.first, r.second - r.first));
+                IniEvent ev;
+                while (reader.next(ev)) {
+                    if (ev.kind == IniEvent::Kind::KeyValue)
+                        slot.entries[std::string(ev.key)] = std::string(ev.value);
+                }
+            }
+        });
+        return slot.entries.empty() ? nullptr : &slot.entries;
+    }
+};
+
+// Reports one load to the attached metrics, if any, when it goes out of scope.
+struct LoadStats {
+    explicit LoadStats(ConfigMetrics *metrics) : metrics(metrics) {
+        if (metrics) start = std::chrono::steady_clock::now();
+    }
+    ~LoadStats() {
+        if (!metrics) return;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        metrics->recordLoad(ok, static_cast<uint64_t>(ns.count()), bytes, keys, malformed);
+    }
+
+    ConfigMetrics *metrics;
+    std::chrono::steady_clock::time_point start;
+    bool ok = false;
+    uint64_t bytes = 0;
+    uint64_t keys = 0;
+    uint64_t malformed = 0;
+};
+
+// Load INI-style config file.
+// - path: path to INI file
+// - err: output error message on failure
+// Returns true on success, false on failure.
+bool Config::loadFromFile(const std::string &path, std::string &err) {
+    invalidateLookupCache();
+    data_.reset();
+    lazy_.reset();
+    stamp_ = FileStamp();
+
+    LoadStats stats(metrics_.get());
+    INIPARSERCXX_PROBE1(load__start, path.c_str());
+    IniReader reader;
+    if (!reader.open(path, err)) {
+        INIPARSERCXX_PROBE4(load__done, path.c_str(), 0, 0, 0);
+        return false;
+    }
+
+    // Section map that receives entries; created on the first key of a section.
+    Section *current = nullptr;
+    IniEvent ev;
+    while (reader.next(ev)) {
+        switch (ev.kind) {
+        case IniEvent::Kind::Section:
+            INIPARSERCXX_PROBE3(section, ev.section.data(), ev.section.size(), ev.line);
+            current = nullptr;
+            break;
+        case IniEvent::Kind::KeyValue:
+            // Store the key/value under the current section. Empty section name means top-level.
+            if (!current) current = &mutableSection(std::string(ev.section));
+            (*current)[std::string(ev.key)] = std::string(ev.value);
+            ++stats.keys;
+            break;
+        case IniEvent::Kind::Malformed:
             // malformed/unknown line - ignore but continue parsing the rest of the file
-            continue;
+            INIPARSERCXX_PROBE3(malformed, ev.line, ev.value.data(), ev.value.size());
+            ++stats.malformed;
+            break;
+        }
+    }
+    INIPARSERCXX_PROBE4(load__done, path.c_str(), 1, reader.bytes(), reader.lines());
+    stats.ok = true;
+    stats.bytes = reader.bytes();
+    return true;
+}
+
+// Load INI text from a block reader through a push parser.
+// - read: supplies the input one block at a time
+// - err: output error message on failure
+// - limits: line length, input size and block size bounds
+// Returns true on success, false on failure.
+bool Config::loadFromStream(const BlockReader &read, std::string &err, const ParseLimits &limits) {
+    return loadBlocks(read, err, limits, std::string());
+}
+
+// Load INI file through a fixed-size buffer.
+// - path: path to INI file
+// - err: output error message on failure
+// - limits: line length, file size and buffer size bounds
+// Returns true on success, false on failure.
+bool Config::loadFromFile(const std::string &path, std::string &err, const ParseLimits &limits) {
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    // Errors found before the first read still go through loadBlocks, which
+    // clears the config and counts the failed load.
+    std::string early;
+    if (!file) {
+        early = "Could not open config file: " + path;
+    } else if (limits.max_total_bytes) {
+        // Fail before reading anything if the size is known to be over the limit.
+        std::error_code ec;
+        uint64_t size = std::filesystem::is_regular_file(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+        if (!ec && size > limits.max_total_bytes)
+            early = "Config file is larger than " + std::to_string(limits.max_total_bytes) + " bytes: " + path;
+    }
+    return loadBlocks(
+        [&](char *buf, size_t size, size_t &got, std::string &e) {
+            if (!early.empty()) {
+                e = early;
+                return false;
+            }
+            got = std::fread(buf, 1, size, file.get());
+            if (got < size && std::ferror(file.get())) {
+                e = "Could not read config file: " + path;
+                return false;
+            }
+            return true;
+        },
+        err, limits, path);
+}
+
+// Shared by the streaming loads; name (the path, if any) is appended to limit
+// errors and passed to the load probes.
+bool Config::loadBlocks(const BlockReader &read, std::string &err, const ParseLimits &limits,
+                        const std::string &name) {
+    invalidateLookupCache();
+    data_.reset();
+    lazy_.reset();
+    stamp_ = FileStamp();
+
+    LoadStats stats(metrics_.get());
+    INIPARSERCXX_PROBE1(load__start, name.c_str());
+    const std::string where = name.empty() ? std::string() : ": " + name;
+    const size_t block_size = limits.buffer_size ? limits.buffer_size : ParseLimits().buffer_size;
+    std::unique_ptr<char[]> block(new char[block_size]);
+    IniPushParser parser(limits.max_line_length);
+    auto fail = [&] {
+        INIPARSERCXX_PROBE4(load__done, name.c_str(), 0, stats.bytes, parser.lines());
+        return false;
+    };
+    for (;;) {
+        size_t got = 0;
+        if (!read(block.get(), block_size, got, err)) return fail();
+        if (got == 0) break;
+        stats.bytes += got;
+        if (limits.max_total_bytes && stats.bytes > limits.max_total_bytes) {
+            err = "Config input is larger than " + std::to_string(limits.max_total_bytes) + " bytes" + where;
+            return fail();
         }
+        parser.feed(std::string_view(block.get(), got));
+        if (parser.overlongLine()) {
+            err = "Config line " + std::to_string(parser.overlongLine()) + " is longer than " +
+                  std::to_string(limits.max_line_length) + " bytes" + where;
+            return fail();
+        }
+    }
+    // Parse the unterminated last line here so its counts are taken before finish() resets them.
+    if (!parser.partial_.empty()) parser.parse(parser.partial_);
+    parser.partial_.clear();
+    stats.keys = parser.keys_;
+    stats.malformed = parser.malformed_;
+    INIPARSERCXX_PROBE4(load__done, name.c_str(), 1, stats.bytes, parser.lines());
+    data_ = std::move(parser.finish().data_);
+    stats.ok = true;
+    return true;
+}
+
+// Load INI-style config file, treating malformed input as errors.
+// - path: path to INI file
+// - err: output error message on failure
+// - max_errors: stop after this many problems, 0 for no limit
+// - diagnostics: optional output for all problems found
+// Returns true on success, false on failure.
+bool Config::loadStrict(const std::string &path, std::string &err, size_t max_errors, IniDiagnostics *diagnostics) {
+    invalidateLookupCache();
+    data_.reset();
+    lazy_.reset();
+    stamp_ = FileStamp();
+
+    IniDiagnostics found;
+    found.path_ = path;
+    LoadStats stats(metrics_.get());
+    INIPARSERCXX_PROBE1(load__start, path.c_str());
+    std::shared_ptr<const char> file;
+    size_t size = 0;
+    if (!readFile(path, file, size, err)) {
+        INIPARSERCXX_PROBE4(load__done, path.c_str(), 0, 0, 0);
+        if (diagnostics) *diagnostics = IniDiagnostics();
+        return false;
+    }
+    std::string_view buf(file.get(), size);
+    auto report = [&](const char *at, IniDiagnostic::Code code) {
+        IniDiagnostic d;
+        d.offset = static_cast<uint64_t>(at - buf.data());
+        d.code = code;
+        found.list_.push_back(d);
+        ++stats.malformed;
+        found.stopped_ = max_errors && found.list_.size() >= max_errors;
+    };
 
-        // Extract key and value, trimming both sides.
-        std::string key = trim(s.substr(0, eq));
-        std::string val = trim(s.substr(eq + 1));
-
-        // Remove inline comments from the value (e.g., "value ; comment" or "value # comment").
-        // Find earliest occurrence of either ';' or '#' in the value and trim there.
-        size_t cpos = std::string::npos;
-        for (char c : {';', '#'}) {
-            auto p = val.find(c);
-            if (p != std::string::npos) {
-                if (cpos == std::string::npos) cpos = p;
-                else cpos = std::min(cpos, p);
+    // A key may be set once per section block. Blocks of a section opened
+    // before merge as in loadFromFile, so their keys are tracked per block;
+    // otherwise the section map itself tells.
+    bool reopened = false;
+    std::unordered_set<std::string_view> block_keys;
+
+    IniReader reader(buf);
+    Section *current = nullptr;
+    IniEvent ev;
+    while (!found.stopped_ && reader.next(ev)) {
+        switch (ev.kind) {
+        case IniEvent::Kind::Section:
+            INIPARSERCXX_PROBE3(section, ev.section.data(), ev.section.size(), ev.line);
+            if (ev.section.empty()) report(ev.section.data(), IniDiagnostic::Code::EmptySectionName);
+            current = nullptr;
+            reopened = data_ && data_->count(std::string(ev.section)) != 0;
+            block_keys.clear();
+            break;
+        case IniEvent::Kind::KeyValue:
+            if (ev.key.empty()) {
+                report(ev.key.data(), IniDiagnostic::Code::EmptyKey);
+                break;
+            }
+            if (ev.key[0] == '[') {
+                report(ev.key.data(), IniDiagnostic::Code::UnterminatedSection);
+                break;
             }
+            if (!current) current = &mutableSection(std::string(ev.section));
+            if (!reopened) {
+                if (!current->try_emplace(std::string(ev.key), ev.value).second)
+                    report(ev.key.data(), IniDiagnostic::Code::DuplicateKey);
+            } else if (!block_keys.insert(ev.key).second) {
+                report(ev.key.data(), IniDiagnostic::Code::DuplicateKey);
+            } else {
+                (*current)[std::string(ev.key)] = std::string(ev.value); // later blocks win
+            }
+            ++stats.keys;
+            break;
+        case IniEvent::Kind::Malformed:
+            INIPARSERCXX_PROBE3(malformed, ev.line, ev.value.data(), ev.value.size());
+            report(ev.value.data(), ev.value[0] == '[' ? IniDiagnostic::Code::UnterminatedSection
+                                                       : IniDiagnostic::Code::MissingEquals);
+            break;
+        }
+    }
+    INIPARSERCXX_PROBE4(load__done, path.c_str(), found.empty(), reader.bytes(), reader.lines());
+    stats.bytes = reader.bytes();
+    if (!found.empty()) {
+        data_.reset();
+        found.resolve(buf);
+        err = found.format(0);
+        if (found.size() > 1) err += " (and " + std::to_string(found.size() - 1) + " more)";
+        if (diagnostics) *diagnostics = std::move(found);
+        return false;
+    }
+    if (diagnostics) *diagnostics = IniDiagnostics();
+    stats.ok = true;
+    return true;
+}
+
+// Turn the offsets into lines and columns in a single scan of buf.
+void IniDiagnostics::resolve(std::string_view buf) {
+    positions_.clear();
+    positions_.reserve(list_.size());
+    size_t line = 1, line_start = 0, scanned = 0;
+    for (const IniDiagnostic &d : list_) {
+        size_t offset = static_cast<size_t>(d.offset);
+        const char *p = buf.data() + scanned;
+        const char *end = buf.data() + offset;
+        while ((p = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)))) != nullptr) {
+            ++line;
+            line_start = static_cast<size_t>(++p - buf.data());
+        }
+        scanned = offset;
+        Position pos;
+        pos.line = line;
+        pos.column = offset - line_start + 1;
+        positions_.push_back(pos);
+    }
+}
+
+std::string IniDiagnostics::format(size_t i) const {
+    return path_ + ":" + std::to_string(positions_[i].line) + ":" + std::to_string(positions_[i].column) + ": " +
+           message(list_[i].code);
+}
+
+std::string IniDiagnostics::toString() const {
+    std::string out;
+    for (size_t i = 0; i < list_.size(); ++i) out += format(i) + "\n";
+    if (stopped_) out += path_ + ": stopped after " + std::to_string(list_.size()) + " errors\n";
+    return out;
+}
+
+const char *IniDiagnostics::message(IniDiagnostic::Code code) {
+    switch (code) {
+    case IniDiagnostic::Code::MissingEquals:
+        return "expected a section header, key=value entry or comment";
+    case IniDiagnostic::Code::EmptyKey:
+        return "empty key";
+    case IniDiagnostic::Code::EmptySectionName:
+        return "empty section name";
+    case IniDiagnostic::Code::UnterminatedSection:
+        return "section header without closing ']'";
+    case IniDiagnostic::Code::DuplicateKey:
+        return "duplicate key in section";
+    }
+    return "unknown error";
+}
+
+// Find the start of the next section header line at or after pos.
+// Only lines whose first non-space character is '[' are candidates, so
+// entries inside skipped sections are never tokenized.
+static size_t nextSectionLine(std::string_view buf, size_t pos) {
+    while (pos < buf.size()) {
+        const char *p = static_cast<const char *>(std::memchr(buf.data() + pos, '[', buf.size() - pos));
+        if (!p) return buf.size();
+        size_t at = static_cast<size_t>(p - buf.data());
+        // walk back over indentation to check that '[' starts its line
+        size_t b = at;
+        while (b > 0 && buf[b - 1] != '\n' && std::isspace(static_cast<unsigned char>(buf[b - 1]))) --b;
+        if (b == 0 || buf[b - 1] == '\n') return b;
+        pos = at + 1;
+    }
+    return buf.size();
+}
+
+// Files up to this size are copied by loadLazy instead of staying mapped.
+static const size_t kLazyCopyLimit = 1 << 20;
+
+// Load INI-style config file in lazy mode.
+// The pre-scan only visits header lines (see nextSectionLine) and records the
+// byte range of every section body; entries are parsed by LazyIndex::find.
+bool Config::loadLazy(const std::string &path, std::string &err) {
+    invalidateLookupCache();
+    data_.reset();
+    lazy_.reset();
+    stamp_ = FileStamp();
+
+    LoadStats stats(metrics_.get());
+    INIPARSERCXX_PROBE1(load__start, path.c_str());
+    auto index = std::make_shared<LazyIndex>();
+    size_t size = 0;
+    if (!readFile(path, index->file, size, err, kLazyCopyLimit)) {
+        INIPARSERCXX_PROBE4(load__done, path.c_str(), 0, 0, 0);
+        return false;
+    }
+    index->buf = std::string_view(index->file.get(), size);
+    std::string_view buf = index->buf;
+
+    // Body of the current section starts at begin; top-level entries start at 0.
+    std::string current;
+    size_t begin = 0;
+    auto close = [&](size_t end) {
+        auto &slot = index->sections[current];
+        if (!slot) slot = std::make_unique<LazyIndex::Slot>();
+        if (end > begin) slot->ranges.emplace_back(begin, end);
+    };
+
+    size_t pos = 0;
+    while ((pos = nextSectionLine(buf, pos)) < buf.size()) {
+        const char *start = buf.data() + pos;
+        size_t rest = buf.size() - pos;
+        const char *nl = static_cast<const char *>(std::memchr(start, '\n', rest));
+        size_t len = nl ? static_cast<size_t>(nl - start) : rest;
+        size_t line_end = pos + (nl ? len + 1 : len);
+
+        std::string_view a, b;
+        if (parseLine(std::string_view(start, len), a, b) == LineKind::Section) {
+            close(pos);
+            current.assign(a.data(), a.size());
+            begin = line_end;
         }
-        if (cpos != std::string::npos) val = trim(val.substr(0, cpos));
+        pos = line_end;
+    }
+    close(buf.size());
 
-        // Store the key/value under the current section. Empty section name means top-level.
-        data_[current_section][key] = val;
+    lazy_ = std::move(index);
+    // lines are not counted: the pre-scan skips from header to header
+    INIPARSERCXX_PROBE4(load__done, path.c_str(), 1, size, 0);
+    stats.ok = true;
+    stats.bytes = size; // entries are parsed later and not counted
+    return true;
+}
+
+// Walk buf and call on_entry(section, key, value) for every entry and
+// on_malformed(text) for every malformed line (trimmed) of a section accepted
+// by keep(section). Rejected sections are skipped header to header without
+// tokenizing their lines. on_entry returns false to stop the scan.
+template <class Keep, class OnEntry, class OnMalformed>
+static void scanSections(std::string_view buf, Keep &&keep, OnEntry &&on_entry, OnMalformed &&on_malformed) {
+    std::string_view section;
+    bool in_section = keep(section); // top-level keys come before any header
+    size_t pos = 0;
+    while (pos < buf.size()) {
+        if (!in_section) pos = nextSectionLine(buf, pos);
+        if (pos >= buf.size()) break;
+
+        const char *start = buf.data() + pos;
+        size_t rest = buf.size() - pos;
+        const char *nl = static_cast<const char *>(std::memchr(start, '\n', rest));
+        size_t len = nl ? static_cast<size_t>(nl - start) : rest;
+        pos += nl ? len + 1 : len;
+
+        std::string_view a, b;
+        switch (parseLine(std::string_view(start, len), a, b)) {
+        case LineKind::Section:
+            section = a;
+            in_section = keep(section);
+            break;
+        case LineKind::KeyValue:
+            if (in_section && !on_entry(section, a, b)) return;
+            break;
+        case LineKind::Malformed:
+            if (in_section) on_malformed(a);
+            break;
+        default:
+            break;
+        }
     }
+}
+
+// Load only the sections accepted by filter.
+bool Config::loadFromFile(const std::string &path, std::string &err, const SectionFilter &filter) {
+    invalidateLookupCache();
+    data_.reset();
+    lazy_.reset();
+    stamp_ = FileStamp();
+
+    LoadStats stats(metrics_.get());
+    INIPARSERCXX_PROBE1(load__start, path.c_str());
+    std::shared_ptr<const char> file;
+    size_t size = 0;
+    if (!readFile(path, file, size, err)) {
+        INIPARSERCXX_PROBE4(load__done, path.c_str(), 0, 0, 0);
+        return false;
+    }
+
+    std::string_view buf(file.get(), size);
+    // Line numbers are only needed by the probes, so they are counted lazily
+    // (probe arguments are not evaluated unless probes are compiled in).
+    size_t line = 1;
+    const char *counted = buf.data();
+    auto lineOf = [&](const char *at) {
+        line += static_cast<size_t>(std::count(counted, at, '\n'));
+        counted = at;
+        return line;
+    };
+    (void)lineOf;
+
+    Section *current = nullptr;
+    scanSections(
+        buf,
+        [&](std::string_view section) {
+            current = nullptr;
+            return filter(section);
+        },
+        [&](std::string_view section, std::string_view key, std::string_view value) {
+            if (!current) current = &mutableSection(std::string(section));
+            (*current)[std::string(key)] = std::string(value);
+            ++stats.keys;
+            return true;
+        },
+        [&](std::string_view text) {
+            INIPARSERCXX_PROBE3(malformed, lineOf(text.data()), text.data(), text.size());
+            (void)text;
+            ++stats.malformed;
+        });
+    INIPARSERCXX_PROBE4(load__done, path.c_str(), 1, size,
+                        lineOf(buf.data() + size) - (size == 0 || buf.back() == '\n' ? 1 : 0));
+    stats.ok = true;
+    stats.bytes = size;
     return true;
 }
 
+// Look up one key directly in a file.
+bool Config::peek(const std::string &path, const std::string &section, const std::string &key,
+                  std::string &value, std::string &err, bool last_wins) {
+    std::shared_ptr<const char> file;
+    size_t size = 0;
+    if (!readFile(path, file, size, err)) return false;
+
+    bool found = false;
+    scanSections(
+        std::string_view(file.get(), size),
+        [&](std::string_view name) { return name == section; },
+        [&](std::string_view, std::string_view k, std::string_view v) {
+            if (k != key) return true;
+            value.assign(v.data(), v.size());
+            found = true;
+            return last_wins;
+        },
+        [](std::string_view) {});
+    return found;
+}
+
+// Feed the next chunk of input.
+// Lines are split on '\n'; a line cut by the chunk boundary is completed by later chunks.
+void IniPushParser::feed(std::string_view chunk) {
+    if (overlong_) return;
+    const char *p = chunk.data();
+    const char *end = p + chunk.size();
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', chunk.size()));
+
+    // Complete the line carried over from the previous chunk first.
+    if (!partial_.empty()) {
+        if (tooLong(partial_.size() + static_cast<size_t>((nl ? nl : end) - p))) return;
+        if (!nl) {
+            partial_.append(p, chunk.size());
+            return;
+        }
+        partial_.append(p, static_cast<size_t>(nl - p));
+        parse(partial_);
+        partial_.clear();
+        p = nl + 1;
+        nl = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    }
+
+    // Parse complete lines straight out of the chunk.
+    while (nl) {
+        if (tooLong(static_cast<size_t>(nl - p))) return;
+        parse(std::string_view(p, static_cast<size_t>(nl - p)));
+        p = nl + 1;
+        nl = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    }
+    if (tooLong(static_cast<size_t>(end - p))) return;
+    partial_.assign(p, static_cast<size_t>(end - p));
+}
+
+// Check the next line's length against max_line_length and remember the first violation.
+bool IniPushParser::tooLong(size_t len) {
+    if (!max_line_ || len <= max_line_) return false;
+    overlong_ = line_ + 1;
+    partial_.clear();
+    return true;
+}
+
+// Finish parsing and hand over the built config.
+Config IniPushParser::finish() {
+    if (!partial_.empty()) parse(partial_);
+    Config out = std::move(config_);
+    config_ = Config();
+    partial_.clear();
+    section_.clear();
+    current_ = nullptr;
+    line_ = 0;
+    keys_ = 0;
+    malformed_ = 0;
+    overlong_ = 0;
+    return out;
+}
+
+// Parse one complete line into the config being built.
+void IniPushParser::parse(std::string_view line) {
+    ++line_;
+    std::string_view a, b;
+    switch (parseLine(line, a, b)) {
+    case LineKind::Section:
+        INIPARSERCXX_PROBE3(section, a.data(), a.size(), line_);
+        section_.assign(a.data(), a.size());
+        current_ = nullptr;
+        break;
+    case LineKind::KeyValue:
+        if (!current_) current_ = &config_.mutableSection(section_);
+        (*current_)[std::string(a)] = std::string(b);
+        ++keys_;
+        break;
+    case LineKind::Malformed:
+        INIPARSERCXX_PROBE3(malformed, line_, line.data(), line.size());
+        ++malformed_;
+        break;
+    default:
+        break;
+    }
+}
+
 // Retrieve a value from the parsed config.
 // If section or key does not exist, return default_val.
 std::string Config::get(const std::string &section, const std::string &key, const std::string &default_val) const {
-    auto sit = data_.find(section);
-    if (sit == data_.end()) return default_val;
-    auto kit = sit->second.find(key);
-    if (kit == sit->second.end()) return default_val;
-    return kit->second;
-}
\ No newline at end of file
+    const std::string *value = find(section, key, INIPARSERCXX_CALLER());
+    return value ? *value : default_val;
+}
+
+const std::string *Config::find(const std::string &section, const std::string &key) const {
+    return find(section, key, INIPARSERCXX_CALLER());
+}
+
+// Shared by get() and find(): lookup plus the optional cache, profiler, metrics and probes.
+const std::string *Config::find(const std::string &section, const std::string &key, const void *call_site) const {
+    const std::string *value = cache_ ? cachedLookup(section, key) : lookup(section, key);
+    if (profiler_) profiler_->record(section, key, value != nullptr, call_site);
+    if (metrics_) metrics_->recordGet(value != nullptr);
+    if (value) INIPARSERCXX_PROBE2(get__hit, section.c_str(), key.c_str());
+    else INIPARSERCXX_PROBE2(get__miss, section.c_str(), key.c_str());
+    return value;
+}
+
+const std::string *Config::lookup(const std::string &section, const std::string &key) const {
+    const Section *sec = this->section(section);
+    if (!sec) return nullptr;
+    auto kit = sec->find(key);
+    return kit == sec->end() ? nullptr : &kit->second;
+}
+
+// Lookup cache.
+// Entries remember a value pointer (or nullptr for a miss) together with the
+// config and the generation they were filled under. Every change to a cached
+// config bumps g_cache_generation, which makes all entries of all threads stale,
+// so a pointer is only used while the map node it points to is unchanged.
+// Slots are picked from the addresses and lengths of the caller's strings, so a
+// hit costs a few compares and one short memcmp; section and key are copied
+// into the slot's inline buffer, so a miss does not allocate. Lookups whose
+// names do not fit the buffer bypass the cache.
+static std::atomic<uint64_t> g_cache_generation{1};
+
+namespace {
+struct LookupCache {
+    static const size_t kEntries = 256;
+    static const size_t kText = 48; // section and key bytes stored per entry
+    struct Entry {
+        const Config *owner = nullptr;
+        uint64_t generation = 0;
+        const char *section_ptr = nullptr; // caller's buffers the entry was filled from
+        const char *key_ptr = nullptr;
+        uint32_t section_len = 0;
+        uint32_t key_len = 0;
+        const std::string *value = nullptr;
+        char text[kText]; // section followed by key
+    };
+    Entry entries[kEntries];
+    Config::LookupCacheStats stats;
+};
+thread_local LookupCache t_lookup_cache;
+} // namespace
+
+const std::string *Config::cachedLookup(const std::string &section, const std::string &key) const {
+    const size_t slen = section.size(), klen = key.size();
+    if (slen + klen > LookupCache::kText) return lookup(section, key);
+    uintptr_t mix = reinterpret_cast<uintptr_t>(this) ^ (reinterpret_cast<uintptr_t>(section.data()) * 31) ^
+                    (reinterpret_cast<uintptr_t>(key.data()) * 131) ^ (slen << 7) ^ klen;
+    mix *= static_cast<uintptr_t>(0x9E3779B97F4A7C15ull);
+    size_t slot = (mix >> (sizeof(uintptr_t) * 8 - 8)) & (LookupCache::kEntries - 1);
+    uint64_t generation = g_cache_generation.load(std::memory_order_acquire);
+
+    LookupCache &cache = t_lookup_cache;
+    LookupCache::Entry &e = cache.entries[slot];
+    // The caller may have rewritten its buffer in place, so the bytes are compared too.
+    if (e.owner == this && e.generation == generation && e.section_ptr == section.data() &&
+        e.key_ptr == key.data() && e.section_len == slen && e.key_len == klen &&
+        std::memcmp(e.text, section.data(), slen) == 0 && std::memcmp(e.text + slen, key.data(), klen) == 0) {
+        ++cache.stats.hits;
+        return e.value;
+    }
+    ++cache.stats.misses;
+    e.owner = this;
+    e.generation = generation;
+    e.section_ptr = section.data();
+    e.key_ptr = key.data();
+    e.section_len = static_cast<uint32_t>(slen);
+    e.key_len = static_cast<uint32_t>(klen);
+    std::memcpy(e.text, section.data(), slen);
+    std::memcpy(e.text + slen, key.data(), klen);
+    e.value = lookup(section, key);
+    return e.value;
+}
+
+void Config::invalidateLookupCache() const {
+    if (cache_) g_cache_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Config::enableLookupCache(bool enabled) {
+    cache_ = true; // invalidate entries left over from an earlier enable
+    invalidateLookupCache();
+    cache_ = enabled;
+}
+
+void Config::setProfiler(std::shared_ptr<LookupProfiler> profiler) {
+    profiler_ = std::move(profiler);
+}
+
+void Config::setMetrics(std::shared_ptr<ConfigMetrics> metrics) {
+    metrics_ = std::move(metrics);
+}
+
+// Reload unless the file's size and modification time match the last reload.
+// The stamp is taken before loading, so a change racing with the load is
+// picked up by the next call rather than missed.
+bool Config::reloadIfChanged(const std::string &path, bool &reloaded, std::string &err) {
+    FileStamp stamp;
+    std::error_code ec;
+    stamp.size = std::filesystem::file_size(path, ec);
+    if (!ec) stamp.mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    stamp.valid = !ec;
+    stamp.path = path;
+
+    if (stamp.valid && stamp_.valid && stamp_.path == path && stamp_.size == stamp.size && stamp_.mtime == stamp.mtime) {
+        reloaded = false;
+        if (metrics_) metrics_->recordSkippedReload();
+        return true;
+    }
+    reloaded = loadFromFile(path, err);
+    if (reloaded) stamp_ = stamp;
+    return reloaded;
+}
+
+Config::LookupCacheStats Config::lookupCacheStats() {
+    return t_lookup_cache.stats;
+}
+
+void Config::resetLookupCacheStats() {
+    t_lookup_cache.stats = LookupCacheStats();
+}
+
+// Copies and moves keep the cache setting; any object whose contents change
+// under a cached address invalidates first.
+Config::Config(Config &&other) noexcept
+    : data_(std::move(other.data_)), lazy_(std::move(other.lazy_)), cache_(other.cache_),
+      profiler_(std::move(other.profiler_)), metrics_(std::move(other.metrics_)), stamp_(std::move(other.stamp_)) {
+    other.invalidateLookupCache();
+}
+
+Config &Config::operator=(const Config &other) {
+    if (this != &other) {
+        invalidateLookupCache();
+        data_ = other.data_;
+        lazy_ = other.lazy_;
+        cache_ = other.cache_;
+        profiler_ = other.profiler_;
+        metrics_ = other.metrics_;
+        stamp_ = other.stamp_;
+    }
+    return *this;
+}
+
+Config &Config::operator=(Config &&other) noexcept {
+    if (this != &other) {
+        invalidateLookupCache();
+        other.invalidateLookupCache();
+        data_ = std::move(other.data_);
+        lazy_ = std::move(other.lazy_);
+        cache_ = other.cache_;
+        profiler_ = std::move(other.profiler_);
+        metrics_ = std::move(other.metrics_);
+        stamp_ = std::move(other.stamp_);
+    }
+    return *this;
+}
+
+Config::~Config() {
+    invalidateLookupCache();
+}
+
+// Look up a section, parsing it first in lazy mode.
+const Config::Section *Config::section(const std::string &name) const {
+    if (lazy_) return lazy_->find(name);
+    if (!data_) return nullptr;
+    auto sit = data_->find(name);
+    if (sit == data_->end()) return nullptr;
+    return sit->second.get();
+}
+
+// List section names with entries.
+std::vector<std::string> Config::sections() const {
+    std::vector<std::string> names;
+    if (lazy_) {
+        for (const auto &slot : lazy_->sections)
+            if (lazy_->find(slot.first)) names.push_back(slot.first);
+    } else if (data_) {
+        names.reserve(data_->size());
+        for (const auto &sec : *data_) names.push_back(sec.first);
+    }
+    return names;
+}
+
+// Unshare the section table before a write.
+// A lazily loaded config is materialized first, since writes need real maps.
+Config::SectionTable &Config::mutableTable() {
+    invalidateLookupCache();
+    stamp_ = FileStamp();
+    if (lazy_) {
+        auto table = std::make_shared<SectionTable>();
+        for (const auto &slot : lazy_->sections) {
+            if (const Section *sec = lazy_->find(slot.first))
+                (*table)[slot.first] = std::make_shared<Section>(*sec);
+        }
+        lazy_.reset();
+        data_ = std::move(table);
+    } else if (!data_) {
+        data_ = std::make_shared<SectionTable>();
+    } else if (data_.use_count() != 1) {
+        data_ = std::make_shared<SectionTable>(*data_);
+    }
+    return *data_;
+}
+
+// Unshare (or create) one section before a write.
+Config::Section &Config::mutableSection(const std::string &name) {
+    auto &sec = mutableTable()[name];
+    if (!sec) sec = std::make_shared<Section>();
+    else if (sec.use_count() != 1) sec = std::make_shared<Section>(*sec);
+    return *sec;
+}
+
+// Set a value, copying the touched section if it is shared.
+void Config::set(const std::string &section, const std::string &key, const std::string &value) {
+    mutableSection(section)[key] = value;
+}
+
+// Erase a value. Nothing is copied if the key does not exist.
+bool Config::erase(const std::string &section, const std::string &key) {
+    const Section *sec = this->section(section);
+    if (!sec || sec->find(key) == sec->end()) return false;
+    SectionTable &table = mutableTable();
+    Section &entries = mutableSection(section);
+    entries.erase(key);
+    if (entries.empty()) table.erase(section);
+    return true;
+}
+
+// Walk the config in output order and pass every piece of text to out(data, size).
+template <class Out>
+static void renderIni(const Config &cfg, Out &&out) {
+    auto emit = [&](const std::string &name, const Config::Section &sec, bool header) {
+        if (header) {
+            out("[", 1);
+            out(name.data(), name.size());
+            out("]\n", 2);
+        }
+        for (const auto &kv : sec) {
+            out(kv.first.data(), kv.first.size());
+            out("=", 1);
+            out(kv.second.data(), kv.second.size());
+            out("\n", 1);
+        }
+    };
+    // top-level keys must come before any header
+    bool first = true;
+    if (const Config::Section *top = cfg.section("")) {
+        emit("", *top, false);
+        first = false;
+    }
+    for (const std::string &name : cfg.sections()) {
+        if (name.empty()) continue;
+        if (!first) out("\n", 1); // blank line between blocks
+        emit(name, *cfg.section(name), true);
+        first = false;
+    }
+}
+
+size_t Config::serializedSize() const {
+    size_t size = 0;
+    renderIni(*this, [&](const char *, size_t n) { size += n; });
+    return size;
+}
+
+size_t Config::serialize(char *buf) const {
+    char *p = buf;
+    renderIni(*this, [&](const char *data, size_t n) {
+        std::memcpy(p, data, n);
+        p += n;
+    });
+    return static_cast<size_t>(p - buf);
+}
+
+void Config::serialize(std::string &out) const {
+    out.resize(serializedSize());
+    serialize(&out[0]);
+}
+
+// Serialize into a fixed-size chunk buffer that is flushed to the file when full,
+// so saving needs neither a buffer of the whole output nor one syscall per entry.
+bool Config::saveToFile(const std::string &path, std::string &err) const {
+    static const size_t kChunk = 1 << 20;
+    std::unique_ptr<char[]> chunk(new char[kChunk]);
+    size_t used = 0;
+    bool ok = true;
+
+#ifndef INIPARSERCXX_NO_MMAP
+    AtomicFile file;
+    // reserving the exact size keeps the file contiguous and fails early on a full disk
+    if (!file.open(path, err) || !file.reserve(serializedSize(), err)) return false;
+    auto flush = [&] {
+        ok = ok && file.write(chunk.get(), used, err);
+        used = 0;
+    };
+#else
+    std::string tmp = path + ".tmp";
+    std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        err = "Could not create config file: " + tmp;
+        return false;
+    }
+    auto flush = [&] {
+        ok = ok && static_cast<bool>(ofs.write(chunk.get(), static_cast<std::streamsize>(used)));
+        used = 0;
+    };
+#endif
+
+    renderIni(*this, [&](const char *data, size_t n) {
+        while (n > 0) {
+            size_t take = std::min(n, kChunk - used);
+            std::memcpy(chunk.get() + used, data, take);
+            used += take;
+            data += take;
+            n -= take;
+            if (used == kChunk) flush();
+        }
+    });
+    flush();
+
+#ifndef INIPARSERCXX_NO_MMAP
+    return ok && file.commit(err);
+#else
+    ofs.close();
+    ok = ok && !ofs.fail();
+    if (ok) std::remove(path.c_str()); // rename does not replace on Windows
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        err = "Could not write config file: " + path;
+        return false;
+    }
+    return true;
+#endif
+}
+
+static bool isTrimmed(const std::string &s) {
+    return s.empty() || (!std::isspace(static_cast<unsigned char>(s.front())) &&
+                         !std::isspace(static_cast<unsigned char>(s.back())));
+}
+
+bool Config::canSerialize(const std::string &section, const std::string &key, const std::string &value) {
+    if (!isTrimmed(section) || !isTrimmed(key) || !isTrimmed(value)) return false;
+    if (section.find('\n') != std::string::npos) return false;
+    if (key.find_first_of("=\n") != std::string::npos) return false;
+    // a key starting like a comment or header would be read as one
+    if (!key.empty() && (key[0] == '[' || key[0] == ';' || key[0] == '#')) return false;
+    return value.find_first_of(";#\n") == std::string::npos;
+}
@@ -0,0 +1,249 @@
+// CompressedFile implementation - streaming gzip/zstd decompression.
+//
+// The file is read in blocks of kBlock bytes. Each read() call runs the
+// decoder until it produced some output, the caller's buffer is full or the
+// input is exhausted, so memory is bounded by one input block, the caller's
+// output block and the decoder state (32 KiB window for gzip; for zstd the
+// window of the frame, limited to 2^kZstdWindowLog bytes).
+
+#include "iniparsercxx_compress.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef INIPARSERCXX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef INIPARSERCXX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const size_t kBlock = 64 * 1024;
+static const unsigned char kGzipMagic[2] = {0x1f, 0x8b};
+static const unsigned char kZstdMagic[4] = {0x28, 0xb5, 0x2f, 0xfd};
+#ifdef INIPARSERCXX_HAVE_ZSTD
+static const int kZstdWindowLog = 27; // zstd's default limit; larger windows need --long on the compressor
+#endif
+
+static const char *formatName(CompressedFile::Format format) {
+    switch (format) {
+    case CompressedFile::Format::Gzip:
+        return "gzip";
+    case CompressedFile::Format::Zstd:
+        return "zstd";
+    default:
+        return "plain";
+    }
+}
+
+struct CompressedFile::Decoder {
+#ifdef INIPARSERCXX_HAVE_ZLIB
+    z_stream zs{};
+    bool zs_init = false;
+#endif
+#ifdef INIPARSERCXX_HAVE_ZSTD
+    ZSTD_DCtx *zstd = nullptr;
+    size_t zstd_pending = 0; // nonzero while a frame is incomplete
+#endif
+    bool done = false; // end of the last member or frame
+
+    ~Decoder() {
+#ifdef INIPARSERCXX_HAVE_ZLIB
+        if (zs_init) inflateEnd(&zs);
+#endif
+#ifdef INIPARSERCXX_HAVE_ZSTD
+        if (zstd) ZSTD_freeDCtx(zstd);
+#endif
+    }
+};
+
+CompressedFile::CompressedFile() = default;
+
+CompressedFile::~CompressedFile() {
+    if (file_) std::fclose(file_);
+}
+
+CompressedFile::Format CompressedFile::detect(std::string_view head) {
+    if (head.size() >= sizeof(kGzipMagic) && std::memcmp(head.data(), kGzipMagic, sizeof(kGzipMagic)) == 0)
+        return Format::Gzip;
+    if (head.size() >= sizeof(kZstdMagic) && std::memcmp(head.data(), kZstdMagic, sizeof(kZstdMagic)) == 0)
+        return Format::Zstd;
+    return Format::Plain;
+}
+
+bool CompressedFile::supported(Format format) {
+    switch (format) {
+    case Format::Gzip:
+#ifdef INIPARSERCXX_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Format::Zstd:
+#ifdef INIPARSERCXX_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return true;
+    }
+}
+
+// Open a file and set up the decoder for its format.
+// - path: path to the (possibly compressed) INI file
+// - err: output error message on failure
+// Returns true on success, false on failure.
+bool CompressedFile::open(const std::string &path, std::string &err) {
+    if (file_) std::fclose(file_);
+    decoder_.reset();
+    in_pos_ = in_len_ = 0;
+    eof_ = false;
+    compressed_bytes_ = 0;
+    path_ = path;
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        err = "Could not open config file: " + path;
+        return false;
+    }
+    if (!in_) in_.reset(new char[kBlock]);
+    if (!fill(err)) return false;
+    format_ = detect(std::string_view(in_.get(), in_len_));
+    if (!supported(format_)) {
+        err = std::string("Config file is ") + formatName(format_) + " compressed, but " + formatName(format_) +
+              " support is not built in: " + path;
+        return false;
+    }
+    if (format_ == Format::Plain) return true;
+
+    decoder_.reset(new Decoder());
+#ifdef INIPARSERCXX_HAVE_ZLIB
+    if (format_ == Format::Gzip) {
+        if (inflateInit2(&decoder_->zs, 16 + MAX_WBITS) != Z_OK) {
+            err = "Could not initialize gzip decoder";
+            return false;
+        }
+        decoder_->zs_init = true;
+    }
+#endif
+#ifdef INIPARSERCXX_HAVE_ZSTD
+    if (format_ == Format::Zstd) {
+        decoder_->zstd = ZSTD_createDCtx();
+        if (!decoder_->zstd ||
+            ZSTD_isError(ZSTD_DCtx_setParameter(decoder_->zstd, ZSTD_d_windowLogMax, kZstdWindowLog))) {
+            err = "Could not initialize zstd decoder";
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+// Read the next input block once the current one is used up.
+bool CompressedFile::fill(std::string &err) {
+    if (in_pos_ < in_len_ || eof_) return true;
+    in_pos_ = 0;
+    in_len_ = std::fread(in_.get(), 1, kBlock, file_);
+    compressed_bytes_ += in_len_;
+    if (in_len_ < kBlock) {
+        if (std::ferror(file_)) {
+            err = "Could not read config file: " + path_;
+            return false;
+        }
+        eof_ = true;
+    }
+    return true;
+}
+
+bool CompressedFile::read(char *buf, size_t size, size_t &got, std::string &err) {
+    got = 0;
+    if (!file_) {
+        err = "Config file is not open";
+        return false;
+    }
+    if (format_ == Format::Plain) {
+        // Hand out what is left of the detection block, then read straight into buf.
+        while (got < size) {
+            if (!fill(err)) return false;
+            if (in_pos_ == in_len_) break;
+            size_t n = std::min(size - got, in_len_ - in_pos_);
+            std::memcpy(buf + got, in_.get() + in_pos_, n);
+            in_pos_ += n;
+            got += n;
+        }
+        return true;
+    }
+
+    Decoder &d = *decoder_;
+    while (got == 0 && !d.done) {
+        if (!fill(err)) return false;
+        [[maybe_unused]] bool more_input = in_pos_ < in_len_;
+#ifdef INIPARSERCXX_HAVE_ZLIB
+        if (format_ == Format::Gzip) {
+            // Called without input too: the decoder may still hold output that did not fit last time.
+            d.zs.next_in = reinterpret_cast<Bytef *>(in_.get() + in_pos_);
+            d.zs.avail_in = static_cast<uInt>(in_len_ - in_pos_);
+            d.zs.next_out = reinterpret_cast<Bytef *>(buf);
+            d.zs.avail_out = static_cast<uInt>(std::min<size_t>(size, 1u << 30));
+            int rc = inflate(&d.zs, Z_NO_FLUSH);
+            in_pos_ = in_len_ - d.zs.avail_in;
+            got = static_cast<size_t>(reinterpret_cast<char *>(d.zs.next_out) - buf);
+            if (rc == Z_STREAM_END) {
+                // Another member may follow (e.g. files joined with cat).
+                if (!fill(err)) return false;
+                if (in_pos_ == in_len_) d.done = true;
+                else inflateReset(&d.zs);
+            } else if (rc == Z_BUF_ERROR && !more_input) {
+                err = "Truncated gzip config file: " + path_;
+                return false;
+            } else if (rc != Z_OK) {
+                err = "Corrupt gzip config file: " + path_;
+                return false;
+            }
+            continue;
+        }
+#endif
+#ifdef INIPARSERCXX_HAVE_ZSTD
+        if (format_ == Format::Zstd) {
+            if (!more_input && d.zstd_pending == 0) {
+                d.done = true;
+                break;
+            }
+            ZSTD_inBuffer in = {in_.get(), in_len_, in_pos_};
+            ZSTD_outBuffer out = {buf, size, 0};
+            size_t rc = ZSTD_decompressStream(d.zstd, &out, &in);
+            if (ZSTD_isError(rc)) {
+                err = "Corrupt zstd config file: " + path_ + " (" + ZSTD_getErrorName(rc) + ")";
+                return false;
+            }
+            in_pos_ = in.pos;
+            got = out.pos;
+            d.zstd_pending = rc;
+            if (!more_input && got == 0) {
+                err = "Truncated zstd config file: " + path_;
+                return false;
+            }
+            continue;
+        }
+#endif
+        break;
+    }
+    return true;
+}
+
+bool CompressedFile::load(Config &cfg, const std::string &path, std::string &err, const ParseLimits &limits) {
+    CompressedFile file;
+    // An open failure still goes through loadBlocks, which clears cfg and
+    // counts the failed load, as Config::loadFromFile does.
+    std::string early;
+    bool opened = file.open(path, early);
+    return cfg.loadBlocks(
+        [&](char *buf, size_t size, size_t &got, std::string &e) {
+            if (!opened) {
+                e = early;
+                return false;
+            }
+            return file.read(buf, size, got, e);
+        },
+        err, limits, path);
+}
@@ -0,0 +1,188 @@
+// ConcurrentConfig implementation - sharded reader/writer locking.
+//
+// Each section lives in exactly one shard, chosen by hashing its name. Readers
+// take the shard lock shared, writers exclusive. Section maps are held through
+// shared_ptr like in Config, so snapshot() can hand them out without copying;
+// a writer copies a section first if a snapshot still references it.
+//
+// Operations that touch several shards (reset, snapshot, Transaction::commit)
+// lock them in index order through RAII guards, which keeps them deadlock-free
+// against each other and releases the locks if anything throws. A commit copies
+// only the sections it writes to and swaps the copies in with pointer swaps.
+// Because each holds all its locks before reading or writing anything, a
+// snapshot never observes part of a committed transaction.
+
+#include "iniparsercxx_concurrent.hpp"
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+size_t ConcurrentConfig::shardIndex(const std::string &section) {
+    return std::hash<std::string>()(section) % kShards;
+}
+
+bool ConcurrentConfig::loadFromFile(const std::string &path, std::string &err) {
+    Config cfg;
+    if (!cfg.loadFromFile(path, err)) return false;
+    reset(cfg);
+    return true;
+}
+
+// Replace all contents. Sections are shared with cfg until either side writes.
+void ConcurrentConfig::reset(const Config &cfg) {
+    std::array<std::unordered_map<std::string, std::shared_ptr<Config::Section>>, kShards> next;
+    for (const std::string &name : cfg.sections()) {
+        std::shared_ptr<Config::Section> sec;
+        if (cfg.data_) sec = cfg.data_->at(name);
+        else sec = std::make_shared<Config::Section>(*cfg.section(name)); // lazy mode
+        next[shardIndex(name)].emplace(name, std::move(sec));
+    }
+
+    {
+        // Array elements are destroyed in reverse, so the locks are released in reverse order.
+        std::array<std::unique_lock<std::shared_mutex>, kShards> locks;
+        for (size_t i = 0; i < kShards; ++i) locks[i] = std::unique_lock<std::shared_mutex>(shards_[i].mutex);
+        for (size_t i = 0; i < kShards; ++i) shards_[i].sections.swap(next[i]);
+    }
+    // old sections are released here, outside the locks
+}
+
+std::string ConcurrentConfig::get(const std::string &section, const std::string &key,
+                                  const std::string &default_val) const {
+    Shard &shard = shardFor(section);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto sit = shard.sections.find(section);
+    if (sit == shard.sections.end()) return default_val;
+    auto kit = sit->second->find(key);
+    if (kit == sit->second->end()) return default_val;
+    return kit->second;
+}
+
+void ConcurrentConfig::set(const std::string &section, const std::string &key, const std::string &value) {
+    Shard &shard = shardFor(section);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    setLocked(shard.sections, section, key, value);
+}
+
+bool ConcurrentConfig::erase(const std::string &section, const std::string &key) {
+    Shard &shard = shardFor(section);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return eraseLocked(shard.sections, section, key);
+}
+
+void ConcurrentConfig::setLocked(Sections &sections, const std::string &section, const std::string &key,
+                                 const std::string &value) {
+    auto &sec = sections[section];
+    // A count above one means a snapshot or a staged table holds the section;
+    // only the shard can add references, and the caller holds its lock exclusively.
+    if (!sec) sec = std::make_shared<Config::Section>();
+    else if (sec.use_count() != 1) sec = std::make_shared<Config::Section>(*sec);
+    (*sec)[key] = value;
+}
+
+bool ConcurrentConfig::eraseLocked(Sections &sections, const std::string &section, const std::string &key) {
+    auto sit = sections.find(section);
+    if (sit == sections.end() || !sit->second->count(key)) return false;
+    auto &sec = sit->second;
+    if (sec.use_count() != 1) sec = std::make_shared<Config::Section>(*sec);
+    sec->erase(key);
+    if (sec->empty()) sections.erase(sit);
+    return true;
+}
+
+void ConcurrentConfig::Transaction::set(const std::string &section, const std::string &key,
+                                        const std::string &value) {
+    ops_.push_back(Op{section, key, value, false});
+}
+
+void ConcurrentConfig::Transaction::erase(const std::string &section, const std::string &key) {
+    ops_.push_back(Op{section, key, std::string(), true});
+}
+
+// Lock every touched shard, build a new copy of every touched section with the
+// operations applied, then swap the copies into the live tables.
+void ConcurrentConfig::Transaction::commit() {
+    // One staged section per distinct section name, in first-use order.
+    struct Staged {
+        size_t shard;
+        const std::string *name;
+        std::shared_ptr<Config::Section> next;
+        std::shared_ptr<Config::Section> *slot; // live table entry once reserved; stable across rehashes
+    };
+    std::vector<Staged> staged; // destroyed after the locks: the old sections are released outside them
+    std::vector<size_t> op_staged(ops_.size());
+    {
+        std::unordered_map<std::string, size_t> index;
+        for (size_t n = 0; n < ops_.size(); ++n) {
+            auto it = index.emplace(ops_[n].section, staged.size()).first;
+            if (it->second == staged.size())
+                staged.push_back(Staged{shardIndex(ops_[n].section), &ops_[n].section, nullptr, nullptr});
+            op_staged[n] = it->second;
+        }
+    }
+    std::vector<size_t> order;
+    order.reserve(staged.size());
+    for (const Staged &st : staged) order.push_back(st.shard);
+    std::sort(order.begin(), order.end());
+    order.erase(std::unique(order.begin(), order.end()), order.end());
+
+    auto &all = owner_->shards_;
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    locks.reserve(order.size());
+    for (size_t i : order) locks.emplace_back(all[i].mutex);
+
+    // Only the touched sections are copied; the live ones stay as they are.
+    for (Staged &st : staged) {
+        const Sections &live = all[st.shard].sections;
+        auto it = live.find(*st.name);
+        st.next = it != live.end() ? std::make_shared<Config::Section>(*it->second)
+                                   : std::make_shared<Config::Section>();
+    }
+    for (size_t n = 0; n < ops_.size(); ++n) {
+        const Op &op = ops_[n];
+        Config::Section &sec = *staged[op_staged[n]].next;
+        if (op.erase) sec.erase(op.key);
+        else sec[op.key] = op.value;
+    }
+
+    // Reserve table entries for new sections; undone if an allocation throws.
+    size_t reserved = 0;
+    try {
+        for (; reserved < staged.size(); ++reserved) {
+            Staged &st = staged[reserved];
+            st.slot = &all[st.shard].sections.try_emplace(*st.name).first->second;
+        }
+    } catch (...) {
+        for (size_t k = 0; k < reserved; ++k)
+            if (!*staged[k].slot) all[staged[k].shard].sections.erase(*staged[k].name);
+        throw;
+    }
+
+    // Nothing below throws.
+    for (Staged &st : staged) {
+        st.slot->swap(st.next);
+        if ((*st.slot)->empty()) all[st.shard].sections.erase(*st.name);
+    }
+    while (!locks.empty()) locks.pop_back(); // reverse order
+    ops_.clear();
+}
+
+Config ConcurrentConfig::snapshot() const {
+    auto table = std::make_shared<Config::SectionTable>();
+    {
+        // Released even if copying the table throws.
+        std::array<std::shared_lock<std::shared_mutex>, kShards> locks;
+        for (size_t i = 0; i < kShards; ++i) locks[i] = std::shared_lock<std::shared_mutex>(shards_[i].mutex);
+        for (const Shard &shard : shards_)
+            for (const auto &sec : shard.sections) table->emplace(sec.first, sec.second);
+    }
+
+    Config out;
+    out.data_ = std::move(table);
+    return out;
+}
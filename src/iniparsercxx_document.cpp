@@ -0,0 +1,258 @@
+// IniDocument implementation - format-preserving editing.
+//
+// parse() runs the regular IniReader over the source and turns the views in
+// its events back into byte offsets. Edits never touch src_; text() and save()
+// derive a sorted list of splices (replace [begin, end) with text) from the
+// entry state and copy everything in between verbatim:
+// - a changed value replaces its value range,
+// - an erased entry removes its whole line,
+// - keys added to an existing section are inserted after its last entry,
+// - new sections are appended at the end of the file.
+
+#include "iniparsercxx_document.hpp"
+#include "iniparsercxx.hpp"
+#include "iniparsercxx_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Start of the line containing pos.
+static size_t lineBegin(const std::string &s, size_t pos) {
+    while (pos > 0 && s[pos - 1] != '\n') --pos;
+    return pos;
+}
+
+// End of the line containing pos, past its '\n' if there is one.
+static size_t lineEnd(const std::string &s, size_t pos) {
+    size_t nl = s.find('\n', pos);
+    return nl == std::string::npos ? s.size() : nl + 1;
+}
+
+// Modification time in nanoseconds, to notice edits made by others.
+static long long mtimeOf(const struct stat &st) {
+#if defined(__APPLE__)
+    return static_cast<long long>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+}
+
+bool IniDocument::load(const std::string &path, std::string &err) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        err = "Could not open config file: " + path;
+        return false;
+    }
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    parse(ss.str());
+
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0) {
+        file_size_ = static_cast<size_t>(st.st_size);
+        file_mtime_ = mtimeOf(st);
+    }
+    path_ = path;
+    return true;
+}
+
+void IniDocument::parse(std::string text) {
+    src_ = std::move(text);
+    path_.clear();
+    entries_.clear();
+    sections_.clear();
+    section_index_.clear();
+
+    const char *base = src_.data();
+    size_t current = sectionFor("").index; // top-level section
+
+    IniReader reader(src_);
+    IniEvent ev;
+    while (reader.next(ev)) {
+        if (ev.kind == IniEvent::Kind::Section) {
+            current = sectionFor(std::string(ev.section)).index;
+            Section &sec = sections_[current];
+            sec.in_source = true;
+            // new keys go after the header until the section has entries
+            if (sec.keys.empty()) sec.insert_at = lineEnd(src_, static_cast<size_t>(ev.section.data() - base));
+        } else if (ev.kind == IniEvent::Kind::KeyValue) {
+            Entry e;
+            e.section = current;
+            e.val_begin = static_cast<size_t>(ev.value.data() - base);
+            e.val_end = e.val_begin + ev.value.size();
+            e.line_begin = lineBegin(src_, static_cast<size_t>(ev.key.data() - base));
+            e.line_end = lineEnd(src_, e.val_end);
+            e.value.assign(ev.value.data(), ev.value.size());
+            sections_[current].keys[std::string(ev.key)].push_back(entries_.size());
+            sections_[current].insert_at = e.line_end;
+            entries_.push_back(std::move(e));
+        }
+    }
+}
+
+// Find or create the logical section called name.
+IniDocument::Section &IniDocument::sectionFor(const std::string &name) {
+    auto it = section_index_.find(name);
+    if (it != section_index_.end()) return sections_[it->second];
+    section_index_.emplace(name, sections_.size());
+    sections_.emplace_back();
+    sections_.back().name = name;
+    sections_.back().index = sections_.size() - 1;
+    // top-level keys have no header and always go at the start of the file
+    sections_.back().in_source = name.empty();
+    return sections_.back();
+}
+
+const IniDocument::Entry *IniDocument::find(const std::string &section, const std::string &key) const {
+    auto sit = section_index_.find(section);
+    if (sit == section_index_.end()) return nullptr;
+    const auto &keys = sections_[sit->second].keys;
+    auto kit = keys.find(key);
+    if (kit == keys.end() || kit->second.empty()) return nullptr;
+    const Entry &e = entries_[kit->second.back()];
+    return e.erased ? nullptr : &e;
+}
+
+std::string IniDocument::get(const std::string &section, const std::string &key,
+                             const std::string &default_val) const {
+    const Entry *e = find(section, key);
+    return e ? e->value : default_val;
+}
+
+bool IniDocument::set(const std::string &section, const std::string &key, const std::string &value) {
+    // the text must read back as the same entry
+    if (!Config::canSerialize(section, key, value) || section.find(']') != std::string::npos ||
+        key.find(']') != std::string::npos || value.find(']') != std::string::npos)
+        return false;
+    Section &sec = sectionFor(section);
+    auto &occurrences = sec.keys[key];
+    if (!occurrences.empty() && !entries_[occurrences.back()].erased) {
+        entries_[occurrences.back()].value = value;
+        return true;
+    }
+    Entry e;
+    e.section = sec.index;
+    e.line_begin = e.line_end = e.val_begin = e.val_end = 0;
+    e.value = value;
+    e.key = key;
+    e.original = false;
+    occurrences.push_back(entries_.size());
+    entries_.push_back(std::move(e));
+    return true;
+}
+
+bool IniDocument::erase(const std::string &section, const std::string &key) {
+    if (!find(section, key)) return false;
+    for (size_t i : sections_[section_index_.at(section)].keys.at(key)) entries_[i].erased = true;
+    return true;
+}
+
+// Build the edit list against the source, sorted by position.
+std::vector<IniDocument::Splice> IniDocument::splices() const {
+    std::vector<Splice> out;
+    std::vector<std::string> added(sections_.size());
+    for (const Entry &e : entries_) {
+        if (!e.original) {
+            if (!e.erased) added[e.section] += e.key + "=" + e.value + "\n";
+        } else if (e.erased) {
+            out.push_back(Splice{e.line_begin, e.line_end, std::string()});
+        } else if (src_.compare(e.val_begin, e.val_end - e.val_begin, e.value) != 0) {
+            out.push_back(Splice{e.val_begin, e.val_end, e.value});
+        }
+    }
+
+    std::string appended;
+    for (const Section &sec : sections_) {
+        const std::string &text = added[sec.index];
+        if (text.empty()) continue;
+        if (sec.in_source) {
+            size_t at = sec.insert_at;
+            bool open_line = at > 0 && src_[at - 1] != '\n'; // last line has no newline
+            out.push_back(Splice{at, at, (open_line ? "\n" : "") + text});
+        } else {
+            if (!src_.empty() || !appended.empty()) appended += "\n";
+            appended += "[" + sec.name + "]\n" + text;
+        }
+    }
+    if (!appended.empty()) {
+        bool open_line = !src_.empty() && src_.back() != '\n';
+        out.push_back(Splice{src_.size(), src_.size(), (open_line ? "\n" : "") + appended});
+    }
+
+    // insertions sort before a removal starting at the same offset
+    std::stable_sort(out.begin(), out.end(), [](const Splice &a, const Splice &b) {
+        return a.begin != b.begin ? a.begin < b.begin : a.end < b.end;
+    });
+    return out;
+}
+
+size_t IniDocument::pendingEdits() const {
+    return splices().size();
+}
+
+std::string IniDocument::text() const {
+    std::vector<Splice> edits = splices();
+    size_t size = src_.size();
+    for (const Splice &sp : edits) size = size - (sp.end - sp.begin) + sp.text.size();
+
+    std::string out;
+    out.reserve(size);
+    size_t pos = 0;
+    for (const Splice &sp : edits) {
+        out.append(src_, pos, sp.begin - pos);
+        out += sp.text;
+        pos = sp.end;
+    }
+    out.append(src_, pos, std::string::npos);
+    return out;
+}
+
+bool IniDocument::save(const std::string &path, std::string &err) {
+    std::vector<Splice> edits = splices();
+    bool same_size = std::all_of(edits.begin(), edits.end(),
+                                 [](const Splice &sp) { return sp.end - sp.begin == sp.text.size(); });
+
+    struct stat st;
+    bool unchanged_on_disk = !path_.empty() && path == path_ && ::stat(path.c_str(), &st) == 0 &&
+                             static_cast<size_t>(st.st_size) == file_size_ &&
+                             mtimeOf(st) == file_mtime_ && file_size_ == src_.size();
+
+    if (same_size && unchanged_on_disk) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        bool ok = fd >= 0;
+        for (size_t i = 0; ok && i < edits.size(); ++i) {
+            const Splice &sp = edits[i];
+            ok = ::pwrite(fd, sp.text.data(), sp.text.size(), static_cast<off_t>(sp.begin)) ==
+                 static_cast<ssize_t>(sp.text.size());
+        }
+        ok = ok && ::fsync(fd) == 0;
+        if (fd >= 0) ::close(fd);
+        if (!ok) {
+            err = "Could not write config file: " + path;
+            return false;
+        }
+        // the source now matches the edited values; offsets are unchanged
+        for (const Splice &sp : edits) std::memcpy(&src_[sp.begin], sp.text.data(), sp.text.size());
+        if (::stat(path.c_str(), &st) == 0) file_mtime_ = mtimeOf(st);
+        return true;
+    }
+
+    std::string out = text();
+    AtomicFile file;
+    if (!file.open(path, err) || !file.reserve(out.size(), err) || !file.write(out.data(), out.size(), err) ||
+        !file.commit(err))
+        return false;
+    parse(std::move(out));
+    if (::stat(path.c_str(), &st) == 0) {
+        file_size_ = static_cast<size_t>(st.st_size);
+        file_mtime_ = mtimeOf(st);
+    }
+    path_ = path;
+    return true;
+}
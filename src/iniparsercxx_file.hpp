@@ -0,0 +1,143 @@
+#pragma once
+// Durable atomic file replacement (POSIX), shared by Config::saveToFile,
+// IniDocument::save and the journal.
+//
+// The new contents go to a unique temporary file (mkstemp) in the target's
+// directory, which takes over the mode and, where permitted, the owner of an
+// existing target. commit() fsyncs the file, renames it over the target and
+// fsyncs the directory, so after it returns the new file survives a power
+// failure, and readers only ever see the old or the new file. The temporary is
+// removed if the replacement is abandoned.
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class AtomicFile {
+public:
+    AtomicFile() = default;
+    ~AtomicFile() {
+        if (fd_ >= 0) ::close(fd_);
+        if (!tmp_.empty()) ::unlink(tmp_.c_str());
+    }
+
+    AtomicFile(const AtomicFile &) = delete;
+    AtomicFile &operator=(const AtomicFile &) = delete;
+
+    // Create the temporary file for path. Returns false on failure and sets err.
+    bool open(const std::string &path, std::string &err) {
+        path_ = path;
+        std::vector<char> name(path.begin(), path.end());
+        static const char kSuffix[] = ".tmpXXXXXX";
+        name.insert(name.end(), kSuffix, kSuffix + sizeof(kSuffix)); // includes the NUL
+        fd_ = ::mkstemp(name.data());
+        if (fd_ < 0) {
+            err = "Could not create config file: " + path + ".tmp";
+            return false;
+        }
+        tmp_ = name.data();
+        ::fcntl(fd_, F_SETFD, FD_CLOEXEC);
+
+        struct stat st;
+        if (::stat(path.c_str(), &st) == 0) {
+            // Keep the target's permissions (e.g. 0600 for secrets) and owner.
+            // Changing the owner needs privileges and failing to is not an error.
+            if (::fchown(fd_, st.st_uid, st.st_gid) != 0) {
+            }
+            if (::fchmod(fd_, st.st_mode & 07777) != 0) {
+                err = "Could not set permissions of config file: " + tmp_;
+                return false;
+            }
+        } else if (::fchmod(fd_, 0644) != 0) {
+            err = "Could not set permissions of config file: " + tmp_;
+            return false;
+        }
+        return true;
+    }
+
+    // Reserve size bytes up front, so a full disk fails before writing.
+    bool reserve(uint64_t size, std::string &err) {
+#if defined(__linux__)
+        if (size == 0) return true;
+        int rc = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+        // EINVAL/EOPNOTSUPP: the file system cannot preallocate; the write will tell
+        if (rc != 0 && rc != EINVAL && rc != EOPNOTSUPP) {
+            err = "Could not reserve space for config file: " + path_;
+            return false;
+        }
+#else
+        (void)size;
+        (void)err;
+#endif
+        return true;
+    }
+
+    // Append n bytes. Returns false on failure and sets err.
+    bool write(const char *p, size_t n, std::string &err) {
+        while (n > 0) {
+            ssize_t w = ::write(fd_, p, n);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                err = "Could not write config file: " + path_;
+                return false;
+            }
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    int fd() const { return fd_; }
+    const std::string &tmpPath() const { return tmp_; }
+
+    // Flush the data written so far to disk.
+    bool sync(std::string &err) {
+        if (::fsync(fd_) == 0) return true;
+        err = "Could not write config file: " + path_;
+        return false;
+    }
+
+    // Close the temporary file and rename it over the target. The directory is
+    // not synced; see syncDirectory. Returns false on failure and sets err.
+    bool rename(std::string &err) {
+        bool ok = ::close(fd_) == 0;
+        fd_ = -1;
+        if (!ok || std::rename(tmp_.c_str(), path_.c_str()) != 0) {
+            err = "Could not write config file: " + path_;
+            return false;
+        }
+        tmp_.clear();
+        return true;
+    }
+
+    // Flush the data, rename over the target and flush the directory.
+    // Returns false on failure and sets err; the target is unchanged unless
+    // only the directory sync failed.
+    bool commit(std::string &err) {
+        return sync(err) && rename(err) && syncDirectory(path_, err);
+    }
+
+    // fsync the directory containing path, making a rename or create in it durable.
+    static bool syncDirectory(const std::string &path, std::string &err) {
+        size_t slash = path.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        bool ok = dfd >= 0 && ::fsync(dfd) == 0;
+        if (dfd >= 0) ::close(dfd);
+        if (!ok) err = "Could not sync directory: " + dir;
+        return ok;
+    }
+
+private:
+    std::string path_;
+    std::string tmp_; // set while the temporary file exists
+    int fd_ = -1;
+};
+#endif
@@ -0,0 +1,287 @@
+// ConfigHistory implementation - versioned configs in a persistent HAMT.
+//
+// Each version is the root of a two-level hash array mapped trie: the outer trie
+// maps section names to the root of an inner trie, which maps keys to values.
+// Tries are immutable; an update copies only the nodes on the path from the root
+// to the changed entry and shares everything else with the previous version.
+//
+// Node layout: a 32-bit bitmap records which of the 32 child positions at this
+// level are occupied and slots holds only the occupied ones, in bit order.
+// When all hash bits are used up, entries with identical hashes are kept in the
+// collisions list of the last node.
+
+#include "iniparsercxx_history.hpp"
+#include <functional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Number of set bits in x.
+static inline unsigned popcount32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcount(x));
+#else
+    unsigned n = 0;
+    for (; x; x &= x - 1) ++n;
+    return n;
+#endif
+}
+
+template <class V>
+class Hamt {
+public:
+    struct Leaf {
+        size_t hash;
+        std::string key;
+        V value;
+    };
+    struct Node;
+    using LeafPtr = std::shared_ptr<const Leaf>;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // Exactly one of leaf and child is set.
+    struct Slot {
+        LeafPtr leaf;
+        NodePtr child;
+    };
+    struct Node {
+        uint32_t bitmap = 0;
+        std::vector<Slot> slots;
+        std::vector<LeafPtr> collisions; // only used below the last hash level
+    };
+
+    static constexpr unsigned kBits = 5;
+    static constexpr unsigned kHashBits = sizeof(size_t) * 8;
+
+    static size_t hash(const std::string &key) { return std::hash<std::string>()(key); }
+
+    // Return the value for key, or nullptr.
+    static const V *find(const Node *node, const std::string &key) {
+        size_t h = hash(key);
+        for (unsigned shift = 0; node; shift += kBits) {
+            if (shift >= kHashBits) {
+                for (const auto &leaf : node->collisions)
+                    if (leaf->key == key) return &leaf->value;
+                return nullptr;
+            }
+            uint32_t bit = 1u << ((h >> shift) & 31);
+            if (!(node->bitmap & bit)) return nullptr;
+            const Slot &slot = node->slots[popcount32(node->bitmap & (bit - 1))];
+            if (slot.leaf) return slot.leaf->key == key ? &slot.leaf->value : nullptr;
+            node = slot.child.get();
+        }
+        return nullptr;
+    }
+
+    // Return a new root with key set to value.
+    static NodePtr insert(const NodePtr &root, const std::string &key, V value) {
+        auto leaf = std::make_shared<Leaf>(Leaf{hash(key), key, std::move(value)});
+        return insert(root, 0, leaf);
+    }
+
+    // Return a new root without key, or root itself if key is absent.
+    static NodePtr erase(const NodePtr &root, const std::string &key) {
+        bool found = false;
+        NodePtr out = erase(root, 0, hash(key), key, found);
+        return found ? out : root;
+    }
+
+    // Call fn(key, value) for every entry.
+    template <class F>
+    static void forEach(const Node *node, F &&fn) {
+        if (!node) return;
+        for (const auto &leaf : node->collisions) fn(leaf->key, leaf->value);
+        for (const auto &slot : node->slots) {
+            if (slot.leaf) fn(slot.leaf->key, slot.leaf->value);
+            else forEach(slot.child.get(), fn);
+        }
+    }
+
+    // Add every node and leaf reachable from node to seen.
+    static void collect(const Node *node, std::unordered_set<const void *> &seen) {
+        if (!node || !seen.insert(node).second) return;
+        for (const auto &leaf : node->collisions) seen.insert(leaf.get());
+        for (const auto &slot : node->slots) {
+            if (slot.leaf) seen.insert(slot.leaf.get());
+            else collect(slot.child.get(), seen);
+        }
+    }
+
+private:
+    static NodePtr insert(const NodePtr &node, unsigned shift, const LeafPtr &leaf) {
+        auto out = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        if (shift >= kHashBits) {
+            for (auto &l : out->collisions) {
+                if (l->key == leaf->key) {
+                    l = leaf;
+                    return out;
+                }
+            }
+            out->collisions.push_back(leaf);
+            return out;
+        }
+
+        uint32_t bit = 1u << ((leaf->hash >> shift) & 31);
+        size_t pos = popcount32(out->bitmap & (bit - 1));
+        if (!(out->bitmap & bit)) {
+            out->slots.insert(out->slots.begin() + static_cast<std::ptrdiff_t>(pos), Slot{leaf, nullptr});
+            out->bitmap |= bit;
+            return out;
+        }
+
+        Slot &slot = out->slots[pos];
+        if (slot.child) {
+            slot.child = insert(slot.child, shift + kBits, leaf);
+        } else if (slot.leaf->key == leaf->key) {
+            slot.leaf = leaf;
+        } else {
+            // two keys share this position: push both one level down
+            NodePtr sub = insert(nullptr, shift + kBits, slot.leaf);
+            slot = Slot{nullptr, insert(sub, shift + kBits, leaf)};
+        }
+        return out;
+    }
+
+    static NodePtr erase(const NodePtr &node, unsigned shift, size_t h, const std::string &key, bool &found) {
+        if (!node) return node;
+        if (shift >= kHashBits) {
+            for (size_t i = 0; i < node->collisions.size(); ++i) {
+                if (node->collisions[i]->key != key) continue;
+                found = true;
+                if (node->collisions.size() == 1) return nullptr;
+                auto out = std::make_shared<Node>(*node);
+                out->collisions.erase(out->collisions.begin() + static_cast<std::ptrdiff_t>(i));
+                return out;
+            }
+            return node;
+        }
+
+        uint32_t bit = 1u << ((h >> shift) & 31);
+        if (!(node->bitmap & bit)) return node;
+        size_t pos = popcount32(node->bitmap & (bit - 1));
+        const Slot &slot = node->slots[pos];
+
+        NodePtr sub;
+        if (slot.leaf) {
+            if (slot.leaf->key != key) return node;
+            found = true;
+        } else {
+            sub = erase(slot.child, shift + kBits, h, key, found);
+            if (!found) return node;
+        }
+
+        auto out = std::make_shared<Node>(*node);
+        if (sub && sub->collisions.empty() && sub->slots.size() == 1 && sub->slots[0].leaf) {
+            // a lone entry moves back up instead of keeping a one-entry node
+            out->slots[pos] = Slot{sub->slots[0].leaf, nullptr};
+        } else if (sub) {
+            out->slots[pos].child = sub;
+        } else {
+            out->slots.erase(out->slots.begin() + static_cast<std::ptrdiff_t>(pos));
+            out->bitmap &= ~bit;
+        }
+        return out->slots.empty() ? nullptr : NodePtr(out);
+    }
+};
+
+using KeyTrie = Hamt<std::string>;
+using SectionTrie = Hamt<KeyTrie::NodePtr>;
+
+struct ConfigHistory::Version {
+    uint64_t id;
+    SectionTrie::NodePtr root;
+};
+
+ConfigHistory::ConfigHistory(size_t max_versions) : max_versions_(max_versions ? max_versions : 1) {}
+
+ConfigHistory::~ConfigHistory() = default;
+
+// Record a new version.
+// Only entries that differ from the previous version are inserted or erased, so
+// the new root shares all unchanged subtries. Sections whose storage is still
+// shared with the last committed Config (see Config copy-on-write) are skipped
+// without comparing their entries.
+uint64_t ConfigHistory::commit(const Config &cfg) {
+    SectionTrie::NodePtr root = versions_.empty() ? nullptr : versions_.back()->root;
+
+    for (const std::string &name : cfg.sections()) {
+        const Config::Section *sec = cfg.section(name);
+        if (!versions_.empty() && sec == last_.section(name)) continue;
+
+        const KeyTrie::NodePtr *prev = SectionTrie::find(root.get(), name);
+        KeyTrie::NodePtr keys = prev ? *prev : nullptr;
+        for (const auto &kv : *sec) {
+            const std::string *old = KeyTrie::find(keys.get(), kv.first);
+            if (!old || *old != kv.second) keys = KeyTrie::insert(keys, kv.first, kv.second);
+        }
+        std::vector<std::string> removed;
+        KeyTrie::forEach(keys.get(), [&](const std::string &key, const std::string &) {
+            if (!sec->count(key)) removed.push_back(key);
+        });
+        for (const auto &key : removed) keys = KeyTrie::erase(keys, key);
+
+        if (!prev || *prev != keys) root = SectionTrie::insert(root, name, keys);
+    }
+
+    std::vector<std::string> dropped;
+    SectionTrie::forEach(root.get(), [&](const std::string &name, const KeyTrie::NodePtr &) {
+        if (!cfg.section(name)) dropped.push_back(name);
+    });
+    for (const auto &name : dropped) root = SectionTrie::erase(root, name);
+
+    versions_.push_back(std::make_shared<const Version>(Version{next_, std::move(root)}));
+    while (versions_.size() > max_versions_) versions_.pop_front();
+    last_ = cfg;
+    return next_++;
+}
+
+uint64_t ConfigHistory::latest() const {
+    return versions_.empty() ? 0 : versions_.back()->id;
+}
+
+uint64_t ConfigHistory::oldest() const {
+    return versions_.empty() ? 0 : versions_.front()->id;
+}
+
+bool ConfigHistory::contains(uint64_t version) const {
+    return find(version) != nullptr;
+}
+
+// Versions are consecutive, so the position follows from the version number.
+const ConfigHistory::Version *ConfigHistory::find(uint64_t version) const {
+    if (versions_.empty() || version < oldest() || version > latest()) return nullptr;
+    return versions_[static_cast<size_t>(version - oldest())].get();
+}
+
+std::string ConfigHistory::get(uint64_t version, const std::string &section, const std::string &key,
+                               const std::string &default_val) const {
+    const Version *v = find(version);
+    if (!v) return default_val;
+    const KeyTrie::NodePtr *keys = SectionTrie::find(v->root.get(), section);
+    if (!keys) return default_val;
+    const std::string *val = KeyTrie::find(keys->get(), key);
+    return val ? *val : default_val;
+}
+
+bool ConfigHistory::checkout(uint64_t version, Config &out) const {
+    const Version *v = find(version);
+    if (!v) return false;
+    out = Config();
+    SectionTrie::forEach(v->root.get(), [&](const std::string &section, const KeyTrie::NodePtr &keys) {
+        KeyTrie::forEach(keys.get(), [&](const std::string &key, const std::string &value) {
+            out.set(section, key, value);
+        });
+    });
+    return true;
+}
+
+size_t ConfigHistory::nodeCount() const {
+    std::unordered_set<const void *> seen;
+    for (const auto &v : versions_) {
+        SectionTrie::collect(v->root.get(), seen);
+        SectionTrie::forEach(v->root.get(), [&](const std::string &, const KeyTrie::NodePtr &keys) {
+            KeyTrie::collect(keys.get(), seen);
+        });
+    }
+    return seen.size();
+}
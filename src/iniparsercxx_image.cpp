@@ -0,0 +1,220 @@
+// ConfigImage implementation - flat hash index over a string arena.
+//
+// Layout (native byte order, 8-byte aligned sections):
+//     Header   magic, slot/entry counts, offsets of the parts below, total size
+//     Slot[]   power-of-two open-addressing table with linear probing; each slot
+//              holds a 32-bit hash tag and entry index + 1 (0 = empty)
+//     Entry[]  offsets and lengths of section, key and value in the arena
+//     arena    string bytes; each section name is stored once
+//
+// The table is kept at most half full, and the hash tag lets a probe skip
+// non-matching slots without touching the arena. A profile-guided build puts
+// the hottest entries first in every part (see build(cfg, hot)).
+
+#include "iniparsercxx_image.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char kMagic[8] = {'I', 'N', 'I', 'I', 'M', 'G', '1', '\0'};
+
+struct Header {
+    char magic[8];
+    uint32_t slot_count;
+    uint32_t entry_count;
+    uint32_t slots_off;
+    uint32_t entries_off;
+    uint32_t arena_off;
+    uint32_t reserved;
+    uint64_t total_size;
+};
+
+struct Slot {
+    uint32_t tag;
+    uint32_t entry; // index + 1, 0 = empty
+};
+
+struct Entry {
+    uint32_t section_off, section_len;
+    uint32_t key_off, key_len;
+    uint32_t value_off, value_len;
+};
+
+// FNV-1a over section, a separator and key.
+uint64_t hashKey(std::string_view section, std::string_view key) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : section) h = (h ^ c) * 1099511628211ULL;
+    h = (h ^ 0xff) * 1099511628211ULL;
+    for (unsigned char c : key) h = (h ^ c) * 1099511628211ULL;
+    return h;
+}
+
+size_t align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+} // namespace
+
+std::string ConfigImage::build(const Config &cfg) {
+    return build(cfg, {});
+}
+
+// Hot entries (those listed in hot, most read first) are laid out ahead of all
+// others: they claim their home slot before any colder entry can take it, their
+// Entry records are adjacent, and their section, key and value bytes sit
+// together at the start of the arena. Cold entries share one copy of each
+// section name.
+std::string ConfigImage::build(const Config &cfg, const std::vector<LookupProfiler::KeyCount> &hot) {
+    struct Item {
+        const std::string *section;
+        const std::string *key;
+        const std::string *value;
+    };
+
+    std::unordered_map<std::string, size_t> rank;
+    for (size_t i = 0; i < hot.size(); ++i) {
+        std::string id = hot[i].section;
+        id.push_back('\0');
+        id += hot[i].key;
+        rank.emplace(std::move(id), i);
+    }
+
+    // Gather entries and arena layout first so the image is written in one pass.
+    std::vector<std::string> names = cfg.sections();
+    std::vector<std::pair<size_t, Item>> hot_items;
+    std::vector<Item> cold_items;
+    size_t arena_size = 0;
+    std::string id;
+    for (const std::string &name : names) {
+        bool cold_seen = false;
+        for (const auto &kv : *cfg.section(name)) {
+            Item item{&name, &kv.first, &kv.second};
+            arena_size += kv.first.size() + kv.second.size();
+            auto it = rank.end();
+            if (!rank.empty()) {
+                id.assign(name);
+                id.push_back('\0');
+                id += kv.first;
+                it = rank.find(id);
+            }
+            if (it != rank.end()) {
+                hot_items.emplace_back(it->second, item);
+                arena_size += name.size();
+            } else {
+                cold_items.push_back(item);
+                if (!cold_seen) arena_size += name.size();
+                cold_seen = true;
+            }
+        }
+    }
+    std::sort(hot_items.begin(), hot_items.end(),
+              [](const std::pair<size_t, Item> &a, const std::pair<size_t, Item> &b) { return a.first < b.first; });
+
+    size_t entry_count = hot_items.size() + cold_items.size();
+    size_t slot_count = 8;
+    while (slot_count < entry_count * 2) slot_count *= 2;
+
+    size_t slots_off = align8(sizeof(Header));
+    size_t entries_off = align8(slots_off + slot_count * sizeof(Slot));
+    size_t arena_off = align8(entries_off + entry_count * sizeof(Entry));
+    size_t total = arena_off + arena_size;
+    if (total > UINT32_MAX) return std::string(); // offsets are 32-bit
+
+    std::string out(total, '\0');
+    char *base = &out[0];
+    Header h;
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.slot_count = static_cast<uint32_t>(slot_count);
+    h.entry_count = static_cast<uint32_t>(entry_count);
+    h.slots_off = static_cast<uint32_t>(slots_off);
+    h.entries_off = static_cast<uint32_t>(entries_off);
+    h.arena_off = static_cast<uint32_t>(arena_off);
+    h.reserved = 0;
+    h.total_size = total;
+    std::memcpy(base, &h, sizeof(h));
+
+    Slot *slots = reinterpret_cast<Slot *>(base + slots_off);
+    Entry *entries = reinterpret_cast<Entry *>(base + entries_off);
+    size_t arena = arena_off;
+    auto put = [&](const std::string &s) {
+        std::memcpy(base + arena, s.data(), s.size());
+        uint32_t off = static_cast<uint32_t>(arena);
+        arena += s.size();
+        return off;
+    };
+
+    uint32_t n = 0;
+    auto add = [&](const Item &item, uint32_t section_off) {
+        Entry &e = entries[n];
+        e.section_off = section_off;
+        e.section_len = static_cast<uint32_t>(item.section->size());
+        e.key_off = put(*item.key);
+        e.key_len = static_cast<uint32_t>(item.key->size());
+        e.value_off = put(*item.value);
+        e.value_len = static_cast<uint32_t>(item.value->size());
+
+        uint64_t hash = hashKey(*item.section, *item.key);
+        size_t i = static_cast<size_t>(hash) & (slot_count - 1);
+        while (slots[i].entry) i = (i + 1) & (slot_count - 1);
+        slots[i].tag = static_cast<uint32_t>(hash >> 32);
+        slots[i].entry = ++n;
+    };
+
+    for (const auto &hi : hot_items) add(hi.second, put(*hi.second.section));
+    const std::string *section = nullptr;
+    uint32_t section_off = 0;
+    for (const Item &item : cold_items) {
+        if (item.section != section) {
+            section = item.section;
+            section_off = put(*section);
+        }
+        add(item, section_off);
+    }
+    return out;
+}
+
+ConfigImage ConfigImage::view(const void *data, size_t size) {
+    if (!data || size < sizeof(Header)) return ConfigImage();
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.total_size != size) return ConfigImage();
+    if ((h.slot_count & (h.slot_count - 1)) != 0 || h.slot_count == 0) return ConfigImage();
+    if (h.slots_off + static_cast<uint64_t>(h.slot_count) * sizeof(Slot) > h.entries_off ||
+        h.entries_off + static_cast<uint64_t>(h.entry_count) * sizeof(Entry) > h.arena_off || h.arena_off > size)
+        return ConfigImage();
+    return ConfigImage(static_cast<const char *>(data), size);
+}
+
+size_t ConfigImage::entries() const {
+    return data_ ? reinterpret_cast<const Header *>(data_)->entry_count : 0;
+}
+
+bool ConfigImage::find(std::string_view section, std::string_view key, std::string_view &value) const {
+    if (!data_) return false;
+    const Header &h = *reinterpret_cast<const Header *>(data_);
+    const Slot *slots = reinterpret_cast<const Slot *>(data_ + h.slots_off);
+    const Entry *entries = reinterpret_cast<const Entry *>(data_ + h.entries_off);
+
+    uint64_t hash = hashKey(section, key);
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t mask = h.slot_count - 1;
+    for (size_t i = static_cast<size_t>(hash) & mask; slots[i].entry; i = (i + 1) & mask) {
+        if (slots[i].tag != tag) continue;
+        const Entry &e = entries[slots[i].entry - 1];
+        if (std::string_view(data_ + e.key_off, e.key_len) == key &&
+            std::string_view(data_ + e.section_off, e.section_len) == section) {
+            value = std::string_view(data_ + e.value_off, e.value_len);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ConfigImage::get(const std::string &section, const std::string &key,
+                             const std::string &default_val) const {
+    std::string_view value;
+    if (!find(section, key, value)) return default_val;
+    return std::string(value);
+}
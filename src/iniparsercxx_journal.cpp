@@ -0,0 +1,356 @@
+// JournaledConfig implementation - append-only override journal.
+//
+// Journal layout: an 8-byte magic followed by records of
+//     op (1 byte, 'S' = set, 'E' = erase)
+//     section, key and value lengths (3 x uint32, little endian)
+//     section, key and value bytes
+// Each record is written with a single write() on an O_APPEND descriptor. A torn
+// record at the end (crash during a write) is dropped and truncated on open.
+//
+// Compaction edits the current state into the INI file through IniDocument, so
+// comments and layout survive, and then replaces the journal with the records
+// appended since the state was taken. Replaying a journal is idempotent per key,
+// so a crash between the two steps only means the old journal is replayed over
+// the new file, which yields the same state. Entries the INI syntax cannot carry
+// (e.g. values containing ';' or '#') stay in the journal. Writers are only
+// blocked for the final rename of the new journal: the INI file, the tail of
+// records appended meanwhile and the fsyncs are all written without mutex_.
+
+#include "iniparsercxx_journal.hpp"
+#include "iniparsercxx_document.hpp"
+#include "iniparsercxx_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kMagic[8] = {'I', 'N', 'I', 'J', 'R', 'N', 'L', '1'};
+static const size_t kHeader = 1 + 3 * 4;
+
+static void putU32(std::string &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+static uint32_t getU32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+static void encodeRecord(std::string &out, char op, const std::string &section, const std::string &key,
+                         const std::string &value) {
+    out.push_back(op);
+    putU32(out, static_cast<uint32_t>(section.size()));
+    putU32(out, static_cast<uint32_t>(key.size()));
+    putU32(out, static_cast<uint32_t>(value.size()));
+    out += section;
+    out += key;
+    out += value;
+}
+
+// Apply every complete record in buf (after the magic) to cfg.
+// Returns the offset just past the last complete record.
+static size_t replay(const std::string &buf, Config &cfg) {
+    size_t pos = sizeof(kMagic);
+    while (buf.size() - pos >= kHeader) {
+        const char *p = buf.data() + pos;
+        char op = p[0];
+        size_t slen = getU32(p + 1), klen = getU32(p + 5), vlen = getU32(p + 9);
+        if ((op != 'S' && op != 'E') || buf.size() - pos - kHeader < slen + klen + vlen) break;
+        const char *d = p + kHeader;
+        std::string section(d, slen), key(d + slen, klen);
+        if (op == 'S') cfg.set(section, key, std::string(d + slen + klen, vlen));
+        else cfg.erase(section, key);
+        pos += kHeader + slen + klen + vlen;
+    }
+    return pos;
+}
+
+static bool writeAll(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+// Bring the INI file at path in line with snap by editing only the entries that
+// differ. Entries INI text cannot carry are encoded into journal instead.
+static bool foldInto(const std::string &path, const Config &snap, std::string &journal, std::string &err) {
+    IniDocument doc;
+    if (!doc.load(path, err)) {
+        if (::access(path.c_str(), F_OK) == 0) return false;
+        doc.parse(std::string()); // the file was removed: write it anew
+    }
+
+    // what the file holds now, with the same last-wins merging as loadFromFile
+    std::string text = doc.text();
+    Config file;
+    std::string section;
+    IniReader reader(text);
+    IniEvent ev;
+    while (reader.next(ev)) {
+        if (ev.kind == IniEvent::Kind::Section) section.assign(ev.section.data(), ev.section.size());
+        else if (ev.kind == IniEvent::Kind::KeyValue) file.set(section, std::string(ev.key), std::string(ev.value));
+    }
+
+    for (const std::string &name : snap.sections()) {
+        for (const auto &kv : *snap.section(name)) {
+            const std::string *old = file.find(name, kv.first);
+            if (old && *old == kv.second) continue;
+            if (!doc.set(name, kv.first, kv.second)) encodeRecord(journal, 'S', name, kv.first, kv.second);
+        }
+    }
+    for (const std::string &name : file.sections()) {
+        for (const auto &kv : *file.section(name))
+            if (!snap.find(name, kv.first)) doc.erase(name, kv.first);
+    }
+    return doc.pendingEdits() == 0 || doc.save(path, err);
+}
+
+// Copy bytes [from, to) of the journal open as rfd to out in bounded chunks.
+static bool copyRange(int rfd, size_t from, size_t to, AtomicFile &out, const std::string &journal_path,
+                      std::string &err) {
+    static const size_t kChunk = 1 << 16;
+    char buf[kChunk];
+    while (from < to) {
+        size_t n = std::min(kChunk, to - from);
+        ssize_t r = ::pread(rfd, buf, n, static_cast<off_t>(from));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            err = "Could not read journal: " + journal_path;
+            return false;
+        }
+        if (!out.write(buf, static_cast<size_t>(r), err)) return false;
+        from += static_cast<size_t>(r);
+    }
+    return true;
+}
+
+JournaledConfig::JournaledConfig(size_t compact_threshold) : threshold_(compact_threshold) {}
+
+JournaledConfig::~JournaledConfig() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+    close();
+}
+
+void JournaledConfig::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+bool JournaledConfig::open(const std::string &path, std::string &err) {
+    std::lock_guard<std::mutex> compacting(compact_mutex_);
+    Config cfg;
+    if (!cfg.loadFromFile(path, err)) return false;
+
+    std::string journal_path = path + ".journal";
+    std::string buf;
+    {
+        std::ifstream ifs(journal_path, std::ios::binary);
+        if (ifs) {
+            std::ostringstream ss;
+            ss << ifs.rdbuf();
+            buf = ss.str();
+        }
+    }
+    if (buf.empty()) {
+        buf.assign(kMagic, sizeof(kMagic));
+        AtomicFile file;
+        if (!file.open(journal_path, err) || !file.write(buf.data(), buf.size(), err) || !file.commit(err))
+            return false;
+    } else if (buf.size() < sizeof(kMagic) || std::memcmp(buf.data(), kMagic, sizeof(kMagic)) != 0) {
+        err = "Not a config journal: " + journal_path;
+        return false;
+    }
+
+    size_t end = replay(buf, cfg);
+    if (end < buf.size() && ::truncate(journal_path.c_str(), static_cast<off_t>(end)) != 0) {
+        err = "Could not truncate torn journal: " + journal_path;
+        return false;
+    }
+    int fd = ::open(journal_path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) {
+        err = "Could not open journal: " + journal_path;
+        return false;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        close();
+        fd_ = fd;
+        journal_size_ = end;
+        compacted_size_ = sizeof(kMagic);
+        path_ = path;
+        journal_path_ = journal_path;
+        config_ = std::move(cfg);
+    }
+    if (threshold_ && !worker_.joinable()) worker_ = std::thread(&JournaledConfig::compactLoop, this);
+    return true;
+}
+
+std::string JournaledConfig::get(const std::string &section, const std::string &key,
+                                 const std::string &default_val) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return config_.get(section, key, default_val);
+}
+
+bool JournaledConfig::set(const std::string &section, const std::string &key, const std::string &value,
+                          std::string &err) {
+    return append('S', section, key, value, err);
+}
+
+bool JournaledConfig::erase(const std::string &section, const std::string &key, std::string &err) {
+    return append('E', section, key, std::string(), err);
+}
+
+// Append one record, then apply it in memory.
+bool JournaledConfig::append(char op, const std::string &section, const std::string &key,
+                             const std::string &value, std::string &err) {
+    std::string record;
+    encodeRecord(record, op, section, key, value);
+
+    bool wake = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (fd_ < 0) {
+            err = "Journal is not open";
+            return false;
+        }
+        if (!writeAll(fd_, record.data(), record.size())) {
+            err = "Could not append to journal: " + journal_path_;
+            return false;
+        }
+        journal_size_ += record.size();
+        if (op == 'S') config_.set(section, key, value);
+        else config_.erase(section, key);
+        wake = threshold_ && journal_size_ - compacted_size_ > threshold_;
+    }
+    if (wake) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            compact_requested_ = true;
+        }
+        wake_.notify_one();
+    }
+    return true;
+}
+
+bool JournaledConfig::compact(std::string &err) {
+    std::lock_guard<std::mutex> compacting(compact_mutex_);
+
+    Config snap;
+    size_t offset;
+    std::string path, journal_path;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (fd_ < 0) {
+            err = "Journal is not open";
+            return false;
+        }
+        snap = config_;
+        offset = journal_size_;
+        path = path_;
+        journal_path = journal_path_;
+    }
+
+    // Slow part without holding the lock: writers keep appending meanwhile.
+    std::string journal(kMagic, sizeof(kMagic));
+    if (!foldInto(path, snap, journal, err)) return false;
+    size_t base = journal.size();
+
+    AtomicFile file;
+    if (!file.open(journal_path, err) || !file.write(journal.data(), journal.size(), err)) return false;
+    int rfd = ::open(journal_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (rfd < 0) {
+        err = "Could not read journal: " + journal_path;
+        return false;
+    }
+
+    // Carry over the records appended since the snapshot, catching up a few
+    // times so that little is left to copy while writers are blocked.
+    size_t copied = offset;
+    bool ok = true;
+    for (int round = 0; ok && round < 4; ++round) {
+        size_t end;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            end = journal_size_;
+        }
+        if (end == copied) break;
+        ok = copyRange(rfd, copied, end, file, journal_path, err);
+        copied = end;
+    }
+    int fd = -1;
+    ok = ok && file.sync(err);
+    if (ok) {
+        fd = ::open(file.tmpPath().c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0) err = "Could not open journal: " + journal_path;
+        ok = fd >= 0;
+    }
+
+    if (ok) {
+        // Only the last few records and the rename happen under the lock. They
+        // are not fsynced here, just like records written by append().
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        ok = copyRange(rfd, copied, journal_size_, file, journal_path, err) && file.rename(err);
+        if (ok) {
+            close();
+            fd_ = fd;
+            journal_size_ = base + (journal_size_ - offset);
+            compacted_size_ = base;
+        }
+    }
+    ::close(rfd);
+    if (!ok) {
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    return AtomicFile::syncDirectory(journal_path, err);
+}
+
+void JournaledConfig::compactLoop() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stop_ || compact_requested_; });
+        if (stop_) return;
+        compact_requested_ = false;
+        lock.unlock();
+        std::string err;
+        bool ok = compact(err);
+        lock.lock();
+        compact_error_ = ok ? std::string() : err;
+    }
+}
+
+Config JournaledConfig::snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return config_;
+}
+
+size_t JournaledConfig::journalSize() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return journal_size_;
+}
+
+std::string JournaledConfig::lastCompactError() const {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    return compact_error_;
+}
@@ -0,0 +1,129 @@
+// ConfigMetrics implementation - striped counters and Prometheus rendering.
+//
+// Threads are assigned a stripe round-robin on first use, so up to kStripes
+// threads count without sharing a cache line. Counters only ever grow;
+// render() reads each one with a relaxed load, which gives a consistent enough
+// view for scraping.
+
+#include "iniparsercxx_metrics.hpp"
+#include <cstdio>
+#include <utility>
+
+const double ConfigMetrics::kBuckets[] = {0.0001, 0.001, 0.01, 0.1, 1, 10, 60};
+
+static std::atomic<size_t> g_next_stripe{0};
+
+ConfigMetrics::ConfigMetrics(std::string labels) : labels_(std::move(labels)) {
+    for (Stripe &s : stripes_)
+        for (auto &c : s.counters) c.store(0, std::memory_order_relaxed);
+}
+
+ConfigMetrics::Stripe &ConfigMetrics::local() {
+    thread_local size_t stripe = g_next_stripe.fetch_add(1, std::memory_order_relaxed);
+    return stripes_[stripe % kStripes];
+}
+
+uint64_t ConfigMetrics::sum(size_t counter) const {
+    uint64_t total = 0;
+    for (const Stripe &s : stripes_) total += s.counters[counter].load(std::memory_order_relaxed);
+    return total;
+}
+
+void ConfigMetrics::recordLoad(bool ok, uint64_t nanoseconds, uint64_t bytes, uint64_t keys, uint64_t malformed) {
+    Stripe &s = local();
+    s.counters[kLoads].fetch_add(1, std::memory_order_relaxed);
+    if (!ok) s.counters[kLoadFailures].fetch_add(1, std::memory_order_relaxed);
+    s.counters[kLoadNanoseconds].fetch_add(nanoseconds, std::memory_order_relaxed);
+    s.counters[kBytes].fetch_add(bytes, std::memory_order_relaxed);
+    s.counters[kKeys].fetch_add(keys, std::memory_order_relaxed);
+    s.counters[kMalformed].fetch_add(malformed, std::memory_order_relaxed);
+    // non-cumulative here; render() accumulates the buckets
+    size_t b = 0;
+    while (b < kBucketCount && static_cast<double>(nanoseconds) > kBuckets[b] * 1e9) ++b;
+    if (b < kBucketCount) s.counters[kBucket0 + b].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConfigMetrics::recordGet(bool hit) {
+    Stripe &s = local();
+    s.counters[kGets].fetch_add(1, std::memory_order_relaxed);
+    if (!hit) s.counters[kMisses].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConfigMetrics::recordSkippedReload() {
+    local().counters[kReloadsSkipped].fetch_add(1, std::memory_order_relaxed);
+}
+
+ConfigMetrics::Totals ConfigMetrics::totals() const {
+    Totals t;
+    t.loads = sum(kLoads);
+    t.load_failures = sum(kLoadFailures);
+    t.load_nanoseconds = sum(kLoadNanoseconds);
+    t.bytes = sum(kBytes);
+    t.keys = sum(kKeys);
+    t.malformed = sum(kMalformed);
+    t.gets = sum(kGets);
+    t.misses = sum(kMisses);
+    t.reloads_skipped = sum(kReloadsSkipped);
+    return t;
+}
+
+namespace {
+
+// Appends formatted text to a fixed buffer and keeps counting once it is full.
+struct Writer {
+    char *buf;
+    size_t size;
+    size_t len = 0;
+
+    template <class... Args>
+    void put(const char *fmt, Args... args) {
+        char *at = len < size ? buf + len : nullptr;
+        int n = std::snprintf(at, at ? size - len : 0, fmt, args...);
+        if (n > 0) len += static_cast<size_t>(n);
+    }
+};
+
+} // namespace
+
+size_t ConfigMetrics::render(char *buf, size_t size) const {
+    Writer w{buf, size};
+    if (size) buf[0] = '\0';
+    const char *labels = labels_.c_str();
+    const char *open = labels_.empty() ? "" : "{";
+    const char *close = labels_.empty() ? "" : "}";
+
+    struct Metric {
+        const char *name;
+        const char *help;
+        Counter counter;
+    };
+    static const Metric kMetrics[] = {
+        {"iniparsercxx_loads_total", "Config loads attempted.", kLoads},
+        {"iniparsercxx_load_failures_total", "Config loads that failed.", kLoadFailures},
+        {"iniparsercxx_bytes_parsed_total", "Bytes of INI text parsed.", kBytes},
+        {"iniparsercxx_keys_parsed_total", "Entries parsed.", kKeys},
+        {"iniparsercxx_malformed_lines_total", "Malformed lines skipped.", kMalformed},
+        {"iniparsercxx_gets_total", "Lookups through Config::get.", kGets},
+        {"iniparsercxx_get_misses_total", "Lookups that returned the default.", kMisses},
+        {"iniparsercxx_reloads_skipped_total", "Reloads skipped because the file was unchanged.", kReloadsSkipped},
+    };
+    for (const Metric &m : kMetrics) {
+        w.put("# HELP %s %s\n# TYPE %s counter\n%s%s%s%s %llu\n", m.name, m.help, m.name, m.name, open, labels,
+              close, static_cast<unsigned long long>(sum(m.counter)));
+    }
+
+    const char *h = "iniparsercxx_load_duration_seconds";
+    const char *sep = labels_.empty() ? "" : ",";
+    w.put("# HELP %s Duration of config loads.\n# TYPE %s histogram\n", h, h);
+    uint64_t cumulative = 0;
+    for (size_t b = 0; b < kBucketCount; ++b) {
+        cumulative += sum(kBucket0 + b);
+        w.put("%s_bucket{%s%sle=\"%g\"} %llu\n", h, labels, sep, kBuckets[b],
+              static_cast<unsigned long long>(cumulative));
+    }
+    uint64_t count = sum(kLoads);
+    w.put("%s_bucket{%s%sle=\"+Inf\"} %llu\n", h, labels, sep, static_cast<unsigned long long>(count));
+    w.put("%s_sum%s%s%s %.9f\n", h, open, labels, close, static_cast<double>(sum(kLoadNanoseconds)) / 1e9);
+    w.put("%s_count%s%s%s %llu\n", h, open, labels, close, static_cast<unsigned long long>(count));
+    return w.len;
+}
@@ -0,0 +1,241 @@
+// NumaConfig implementation - per-node replicas of a ConfigImage.
+//
+// A ReplicaSet holds one image copy per memory node and a node -> replica map.
+// Sets are immutable: publish() builds a complete set and swaps it in under the
+// state mutex, then bumps the generation. Each thread keeps a few cache slots,
+// each holding an instance id, the generation and the image it last read from
+// that instance, and only takes the mutex when the generation changed.
+//
+// The instance's State owns every set. A replaced set is retired, not freed,
+// while a registered slot still reads its generation, which is what keeps the
+// values returned by find() valid until the thread reads again. Slots refer to
+// the State weakly: a slot whose instance is gone is simply reused, and a slot
+// that is reused or whose thread exits unregisters itself first.
+
+#include "iniparsercxx_numa.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef INIPARSERCXX_HAVE_LIBNUMA
+#include <numa.h>
+#endif
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+struct NumaConfig::ReplicaSet {
+    struct Replica {
+        char *data = nullptr;
+        size_t size = 0;
+        bool on_node = false; // allocated with numa_alloc_onnode
+        ConfigImage image;
+    };
+
+    std::vector<Replica> replicas;
+    std::vector<size_t> node_replica; // indexed by node number
+
+    ~ReplicaSet() {
+        for (Replica &r : replicas) {
+#ifdef INIPARSERCXX_HAVE_LIBNUMA
+            if (r.on_node) {
+                numa_free(r.data, r.size);
+                continue;
+            }
+#endif
+            delete[] r.data;
+        }
+    }
+
+    // Replica for the node the calling thread runs on.
+    const ConfigImage &local() const {
+        size_t replica = 0;
+#if defined(INIPARSERCXX_HAVE_LIBNUMA) && defined(__linux__)
+        if (replicas.size() > 1) {
+            int cpu = sched_getcpu();
+            int node = cpu < 0 ? -1 : numa_node_of_cpu(cpu);
+            if (node >= 0 && static_cast<size_t>(node) < node_replica.size()) replica = node_replica[node];
+        }
+#endif
+        return replicas[replica].image;
+    }
+};
+
+namespace {
+
+const ConfigImage kNoImage;
+
+std::atomic<uint64_t> g_next_id{1};
+
+} // namespace
+
+struct NumaConfig::ThreadCache {
+    struct Slot {
+        uint64_t owner = 0;      // id_ of the instance, 0 if unused
+        uint64_t generation = 0; // of the set image points into
+        const ConfigImage *image = nullptr;
+        std::weak_ptr<State> state;
+    };
+
+    Slot slots[kThreadSlots];
+    size_t next_victim = 0;
+
+    ~ThreadCache() {
+        for (Slot &slot : slots) release(slot);
+    }
+
+    Slot *find(uint64_t owner) {
+        for (Slot &slot : slots)
+            if (slot.owner == owner) return &slot;
+        return nullptr;
+    }
+
+    // A slot for a new instance: a free one, one of a destroyed instance, or
+    // else the next one in turn.
+    Slot &claim() {
+        for (Slot &slot : slots) {
+            if (slot.owner == 0 || slot.state.expired()) {
+                release(slot);
+                return slot;
+            }
+        }
+        Slot &slot = slots[next_victim++ % kThreadSlots];
+        release(slot);
+        return slot;
+    }
+
+    static void release(Slot &slot);
+};
+
+struct NumaConfig::State {
+    std::mutex mutex; // guards the fields below
+    std::shared_ptr<const ReplicaSet> current;
+    uint64_t generation = 0; // of current
+    // replaced sets that a registered slot may still read, with their generation
+    std::vector<std::pair<uint64_t, std::shared_ptr<const ReplicaSet>>> retired;
+    std::vector<const ThreadCache::Slot *> readers;
+
+    // Free the retired sets no reader uses any more.
+    void collect() {
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [&](const std::pair<uint64_t, std::shared_ptr<const ReplicaSet>> &r) {
+                                         return std::none_of(readers.begin(), readers.end(),
+                                                             [&](const ThreadCache::Slot *slot) {
+                                                                 return slot->generation == r.first;
+                                                             });
+                                     }),
+                      retired.end());
+    }
+};
+
+void NumaConfig::ThreadCache::release(Slot &slot) {
+    if (std::shared_ptr<State> state = slot.state.lock()) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->readers.erase(std::remove(state->readers.begin(), state->readers.end(), &slot),
+                             state->readers.end());
+        state->collect();
+    }
+    slot = Slot();
+}
+
+NumaConfig::ThreadCache &NumaConfig::threadCache() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+
+NumaConfig::NumaConfig() : id_(g_next_id.fetch_add(1)), state_(std::make_shared<State>()) {}
+
+NumaConfig::~NumaConfig() = default;
+
+bool NumaConfig::numaAvailable() {
+#ifdef INIPARSERCXX_HAVE_LIBNUMA
+    return numa_available() >= 0;
+#else
+    return false;
+#endif
+}
+
+bool NumaConfig::publish(const Config &cfg, std::string &err, const std::vector<LookupProfiler::KeyCount> &hot) {
+    std::string image = ConfigImage::build(cfg, hot);
+    if (image.empty()) {
+        err = "Config too large for an image";
+        return false;
+    }
+
+    auto set = std::make_shared<ReplicaSet>();
+    auto place = [&](int node) {
+        ReplicaSet::Replica r;
+        r.size = image.size();
+#ifdef INIPARSERCXX_HAVE_LIBNUMA
+        if (node >= 0) {
+            r.data = static_cast<char *>(numa_alloc_onnode(r.size, node));
+            r.on_node = r.data != nullptr;
+        }
+#endif
+        (void)node;
+        if (!r.data) r.data = new char[r.size];
+        std::memcpy(r.data, image.data(), r.size); // first touch happens here, on the bound node
+        r.image = ConfigImage::view(r.data, r.size);
+        set->replicas.push_back(r);
+    };
+
+#ifdef INIPARSERCXX_HAVE_LIBNUMA
+    if (numaAvailable() && numa_max_node() > 0) {
+        int max_node = numa_max_node();
+        set->node_replica.assign(static_cast<size_t>(max_node) + 1, 0);
+        for (int node = 0; node <= max_node; ++node) {
+            if (!numa_bitmask_isbitset(numa_all_nodes_ptr, static_cast<unsigned>(node))) continue;
+            set->node_replica[node] = set->replicas.size();
+            place(node);
+        }
+    }
+#endif
+    if (set->replicas.empty()) place(-1);
+
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->current) state_->retired.emplace_back(state_->generation, std::move(state_->current));
+        state_->current = std::move(set);
+        state_->generation = generation_.fetch_add(1, std::memory_order_release) + 1;
+        state_->collect();
+    }
+    return true;
+}
+
+// Fast path: the thread's cached replica is current. Otherwise register the
+// slot if needed, then fetch the current set and pick the local replica.
+const ConfigImage &NumaConfig::local() const {
+    ThreadCache &cache = threadCache();
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    ThreadCache::Slot *slot = cache.find(id_);
+    if (slot && slot->generation == generation) return *slot->image;
+
+    if (!slot) slot = &cache.claim(); // before locking: may lock another instance
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (slot->owner != id_) {
+        slot->owner = id_;
+        slot->state = state_;
+        state_->readers.push_back(slot);
+    }
+    slot->generation = state_->generation;
+    slot->image = state_->current ? &state_->current->local() : &kNoImage;
+    state_->collect();
+    return *slot->image;
+}
+
+bool NumaConfig::find(std::string_view section, std::string_view key, std::string_view &value) const {
+    return local().find(section, key, value);
+}
+
+std::string NumaConfig::get(const std::string &section, const std::string &key, const std::string &default_val) const {
+    std::string_view value;
+    if (!find(section, key, value)) return default_val;
+    return std::string(value);
+}
+
+size_t NumaConfig::replicas() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->current ? state_->current->replicas.size() : 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+// Static tracepoints (USDT) for perf, bpftrace and SystemTap.
+//
+// Compiled in only with -DINIPARSERCXX_ENABLE_USDT=ON on systems that provide
+// <sys/sdt.h>; otherwise every probe expands to nothing and its arguments are
+// not evaluated. An enabled probe that nobody is attached to is a single nop.
+//
+// Provider "iniparsercxx":
+//     load__start(path)                           path is "" for loadFromStream
+//     load__done(path, ok, bytes, lines)          lines is 0 for lazy loads
+//     section(name, name_len, line)
+//     malformed(line, text, text_len)
+//     get__hit(section, key)
+//     get__miss(section, key)
+// Strings are passed as char pointers; name and text are not NUL-terminated.
+//
+// Example: bpftrace -e 'usdt:./libiniparsercxx.so:iniparsercxx:get__miss
+//                       { @[str(arg0), str(arg1)] = count(); }'
+
+#if defined(INIPARSERCXX_HAVE_USDT)
+#include <sys/sdt.h>
+#define INIPARSERCXX_PROBE1(name, a) DTRACE_PROBE1(iniparsercxx, name, a)
+#define INIPARSERCXX_PROBE2(name, a, b) DTRACE_PROBE2(iniparsercxx, name, a, b)
+#define INIPARSERCXX_PROBE3(name, a, b, c) DTRACE_PROBE3(iniparsercxx, name, a, b, c)
+#define INIPARSERCXX_PROBE4(name, a, b, c, d) DTRACE_PROBE4(iniparsercxx, name, a, b, c, d)
+#else
+#define INIPARSERCXX_PROBE1(name, a) ((void)0)
+#define INIPARSERCXX_PROBE2(name, a, b) ((void)0)
+#define INIPARSERCXX_PROBE3(name, a, b, c) ((void)0)
+#define INIPARSERCXX_PROBE4(name, a, b, c, d) ((void)0)
+#endif
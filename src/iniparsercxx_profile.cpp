@@ -0,0 +1,240 @@
+// LookupProfiler implementation - per-thread sampled lookup counters.
+//
+// Each thread that records gets its own Shard, owned by the profiler's list.
+// Only that thread writes to it: keys and call sites go into fixed-size open
+// addressing tables whose entries are published with a release store and never
+// move or disappear while the shard lives, and counts are relaxed atomics. So
+// sampling takes no lock, and report() and reset() can read concurrently.
+// Keys are stored as "section\0key" so one table covers both levels.
+//
+// Threads find their shard through a thread-local map of weak pointers by
+// profiler id. Ids are never reused, so a matching id means the profiler is
+// alive; expired entries of destroyed profilers are dropped whenever a thread
+// registers a new shard.
+
+#include "iniparsercxx_profile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+
+struct LookupProfiler::Shard {
+    static const size_t kKeys = 4096;
+    static const size_t kCallSites = 256;
+
+    struct KeyEntry {
+        explicit KeyEntry(std::string n) : name(std::move(n)) {}
+        const std::string name; // "section\0key"
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+    struct CallSiteEntry {
+        std::atomic<const void *> address{nullptr};
+        std::atomic<uint64_t> count{0};
+    };
+
+    ~Shard() {
+        for (auto &slot : keys) delete slot.load(std::memory_order_relaxed);
+    }
+
+    // Entry for section/key, inserted if there is room; nullptr when full.
+    KeyEntry *key(const std::string &section, const std::string &key) {
+        std::hash<std::string_view> hasher;
+        size_t h = hasher(section) * 31 + hasher(key);
+        for (size_t n = 0; n < kKeys; ++n, ++h) {
+            std::atomic<KeyEntry *> &slot = keys[h & (kKeys - 1)];
+            KeyEntry *e = slot.load(std::memory_order_relaxed); // this thread is the only writer
+            if (!e) {
+                std::string name;
+                name.reserve(section.size() + 1 + key.size());
+                name.append(section).push_back('\0');
+                name.append(key);
+                e = new KeyEntry(std::move(name));
+                slot.store(e, std::memory_order_release);
+                return e;
+            }
+            const std::string &s = e->name;
+            if (s.size() == section.size() + 1 + key.size() && s.compare(0, section.size(), section) == 0 &&
+                s.compare(section.size() + 1, key.size(), key) == 0)
+                return e;
+        }
+        return nullptr;
+    }
+
+    // Count for call_site, claimed if there is room; nullptr when full.
+    std::atomic<uint64_t> *callSite(const void *call_site) {
+        size_t h = std::hash<const void *>()(call_site);
+        for (size_t n = 0; n < kCallSites; ++n, ++h) {
+            CallSiteEntry &e = call_sites[h & (kCallSites - 1)];
+            const void *a = e.address.load(std::memory_order_relaxed);
+            if (!a) {
+                e.address.store(call_site, std::memory_order_release);
+                return &e.count;
+            }
+            if (a == call_site) return &e.count;
+        }
+        return nullptr;
+    }
+
+    std::atomic<KeyEntry *> keys[kKeys] = {};
+    CallSiteEntry call_sites[kCallSites];
+    std::atomic<uint64_t> dropped{0};
+    unsigned tick = 0; // lookups since the last sample; owner thread only
+};
+
+namespace {
+
+// Shard the calling thread used last, and weak references to its shards by profiler id.
+struct ThreadShards {
+    uint64_t last_id = 0;
+    void *last = nullptr;
+    std::unordered_map<uint64_t, std::weak_ptr<void>> owned;
+};
+
+thread_local ThreadShards t_shards;
+
+std::atomic<uint64_t> g_next_id{1};
+
+// Sort counts in descending order and keep the first n.
+void keepTop(std::vector<LookupProfiler::KeyCount> &v, size_t n) {
+    std::sort(v.begin(), v.end(), [](const LookupProfiler::KeyCount &a, const LookupProfiler::KeyCount &b) {
+        return a.count != b.count ? a.count > b.count : std::tie(a.section, a.key) < std::tie(b.section, b.key);
+    });
+    if (v.size() > n) v.resize(n);
+}
+
+} // namespace
+
+LookupProfiler::LookupProfiler(unsigned sample_every)
+    : id_(g_next_id.fetch_add(1)), sample_every_(sample_every ? sample_every : 1) {}
+
+LookupProfiler::~LookupProfiler() = default;
+
+LookupProfiler::Shard &LookupProfiler::localShard() {
+    ThreadShards &t = t_shards;
+    if (t.last_id == id_) return *static_cast<Shard *>(t.last);
+    auto it = t.owned.find(id_);
+    std::shared_ptr<void> shard = it == t.owned.end() ? nullptr : it->second.lock();
+    if (!shard) {
+        // Drop shards of profilers that no longer exist before adding this one.
+        for (auto o = t.owned.begin(); o != t.owned.end();) o = o->second.expired() ? t.owned.erase(o) : std::next(o);
+        auto fresh = std::make_shared<Shard>();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shards_.push_back(fresh);
+        }
+        t.owned[id_] = fresh;
+        shard = fresh;
+    }
+    t.last_id = id_;
+    t.last = shard.get();
+    return *static_cast<Shard *>(t.last);
+}
+
+void LookupProfiler::record(const std::string &section, const std::string &key, bool hit, const void *call_site) {
+    Shard &shard = localShard();
+    if (++shard.tick < sample_every_) return;
+    shard.tick = 0;
+
+    if (Shard::KeyEntry *e = shard.key(section, key)) (hit ? e->hits : e->misses).fetch_add(1, std::memory_order_relaxed);
+    else shard.dropped.fetch_add(1, std::memory_order_relaxed);
+    if (call_site) {
+        if (std::atomic<uint64_t> *count = shard.callSite(call_site)) count->fetch_add(1, std::memory_order_relaxed);
+        else shard.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+LookupProfiler::Report LookupProfiler::report(const Config &cfg, size_t top_n) const {
+    struct Counts {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+    std::unordered_map<std::string, Counts> keys;
+    std::unordered_map<const void *, uint64_t> call_sites;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &shard : shards_) {
+            for (const auto &slot : shard->keys) {
+                const Shard::KeyEntry *e = slot.load(std::memory_order_acquire);
+                if (!e) continue;
+                Counts &c = keys[e->name];
+                c.hits += e->hits.load(std::memory_order_relaxed);
+                c.misses += e->misses.load(std::memory_order_relaxed);
+            }
+            for (const auto &cs : shard->call_sites) {
+                const void *a = cs.address.load(std::memory_order_acquire);
+                uint64_t n = cs.count.load(std::memory_order_relaxed);
+                if (a && n) call_sites[a] += n;
+            }
+            dropped += shard->dropped.load(std::memory_order_relaxed);
+        }
+    }
+
+    Report out;
+    out.dropped = dropped * sample_every_;
+    for (const auto &kv : keys) {
+        size_t nul = kv.first.find('\0');
+        std::string section = kv.first.substr(0, nul), key = kv.first.substr(nul + 1);
+        if (kv.second.hits) out.hot.push_back({section, key, kv.second.hits * sample_every_});
+        if (kv.second.misses) out.misses.push_back({section, key, kv.second.misses * sample_every_});
+        out.lookups += (kv.second.hits + kv.second.misses) * sample_every_;
+    }
+    keepTop(out.hot, top_n);
+    keepTop(out.misses, top_n);
+
+    std::string name;
+    for (const std::string &section : cfg.sections()) {
+        for (const auto &kv : *cfg.section(section)) {
+            name.assign(section);
+            name.push_back('\0');
+            name.append(kv.first);
+            auto it = keys.find(name);
+            if (it == keys.end() || !it->second.hits) out.unread.emplace_back(section, kv.first);
+        }
+    }
+    std::sort(out.unread.begin(), out.unread.end());
+
+    for (const auto &kv : call_sites) out.call_sites.push_back({kv.first, kv.second * sample_every_});
+    std::sort(out.call_sites.begin(), out.call_sites.end(),
+              [](const CallSite &a, const CallSite &b) { return a.count > b.count; });
+    if (out.call_sites.size() > top_n) out.call_sites.resize(top_n);
+    return out;
+}
+
+void LookupProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &shard : shards_) {
+        for (auto &slot : shard->keys) {
+            if (Shard::KeyEntry *e = slot.load(std::memory_order_acquire)) {
+                e->hits.store(0, std::memory_order_relaxed);
+                e->misses.store(0, std::memory_order_relaxed);
+            }
+        }
+        for (auto &cs : shard->call_sites) cs.count.store(0, std::memory_order_relaxed);
+        shard->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string LookupProfiler::Report::toString() const {
+    std::string out = "lookups: " + std::to_string(lookups) + "\n";
+    auto list = [&](const char *title, const std::vector<KeyCount> &v) {
+        out += title;
+        for (const KeyCount &k : v) out += "  " + std::to_string(k.count) + "  [" + k.section + "] " + k.key + "\n";
+    };
+    list("hot keys:\n", hot);
+    list("misses:\n", misses);
+    out += "unread keys:\n";
+    for (const auto &k : unread) out += "  [" + k.first + "] " + k.second + "\n";
+    out += "call sites:\n";
+    char addr[32];
+    for (const CallSite &c : call_sites) {
+        std::snprintf(addr, sizeof(addr), "%p", c.address);
+        out += "  " + std::to_string(c.count) + "  " + addr + "\n";
+    }
+    if (dropped) out += "dropped samples: " + std::to_string(dropped) + "\n";
+    return out;
+}
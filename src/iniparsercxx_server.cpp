@@ -0,0 +1,548 @@
+// ConfigServer / ConfigClient implementation - config lookups over a Unix socket.
+//
+// Frame: length (uint32, bytes after this field), op (1 byte), request id
+// (uint32), payload. Ops:
+//     'G' get        count (uint32), then per key: section length, section,
+//                    key length, key
+//     'V' values     answer to 'G': generation (uint64), count (uint32), then per
+//                    key: found (1 byte), value length (uint32), value
+//     'S' subscribe  no payload
+//     'R' reload     generation (uint64); answers 'S' with its id, then pushed
+//                    with id 0 after every publish
+//     'X' error      message; the server closes the connection after sending it
+//
+// The server answers from a ConfigImage of the published config, so a lookup
+// is a hash probe over one buffer. Each batch is answered from a single
+// generation.
+
+#include "iniparsercxx_server.hpp"
+#include "iniparsercxx_image.hpp"
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef MSG_NOSIGNAL
+static const int kSendFlags = MSG_NOSIGNAL;
+#else
+static const int kSendFlags = 0;
+#endif
+
+static const size_t kFrameHeader = 4 + 1 + 4;
+static const uint32_t kMaxFrame = 16u << 20;
+static const size_t kMaxPendingOutput = 1u << 20; // stop reading from a client that does not read its answers
+
+static void putU32(std::string &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+static void putU64(std::string &out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+static uint32_t getU32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+static uint64_t getU64(const char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+// Start a frame in out; finishFrame() fills in the length once the payload is appended.
+static size_t beginFrame(std::string &out, char op, uint32_t id) {
+    size_t start = out.size();
+    putU32(out, 0);
+    out.push_back(op);
+    putU32(out, id);
+    return start;
+}
+
+static void finishFrame(std::string &out, size_t start) {
+    uint32_t len = static_cast<uint32_t>(out.size() - start - 4);
+    for (int i = 0; i < 4; ++i) out[start + i] = static_cast<char>((len >> (8 * i)) & 0xff);
+}
+
+// Read a length-prefixed string from payload at pos.
+static bool getString(const std::string &payload, size_t &pos, std::string_view &s) {
+    if (payload.size() - pos < 4) return false;
+    size_t len = getU32(payload.data() + pos);
+    pos += 4;
+    if (payload.size() - pos < len) return false;
+    s = std::string_view(payload.data() + pos, len);
+    pos += len;
+    return true;
+}
+
+static bool sendAll(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::send(fd, p, n, kSendFlags);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+static bool socketAddress(const std::string &path, sockaddr_un &addr, std::string &err) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        err = "Socket path too long: " + path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+struct ConfigServer::Connection {
+    explicit Connection(int fd_) : fd(fd_) {}
+
+    int fd;
+    std::string in;      // received bytes not yet parsed into frames
+    std::string out;     // answers not yet sent
+    size_t out_pos = 0;  // bytes of out already sent
+    bool subscribed = false;
+    bool closing = false; // close once out is flushed
+};
+
+ConfigServer::ConfigServer() {
+    if (::pipe(wake_fds_) == 0) {
+        for (int fd : wake_fds_) ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+ConfigServer::~ConfigServer() {
+    for (auto &conn : connections_) ::close(conn->fd);
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+    }
+    for (int fd : wake_fds_)
+        if (fd >= 0) ::close(fd);
+}
+
+bool ConfigServer::listen(const std::string &socket_path, std::string &err, unsigned mode) {
+    sockaddr_un addr;
+    if (!socketAddress(socket_path, addr, err)) return false;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        err = "Could not create socket: " + socket_path;
+        return false;
+    }
+    ::unlink(socket_path.c_str());
+    // bind creates the file under the umask; fix the mode before listen so no
+    // client can connect while it is wider
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        err = "Could not listen on socket: " + socket_path;
+        return false;
+    }
+    if (::chmod(socket_path.c_str(), mode) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        ::unlink(socket_path.c_str());
+        err = "Could not listen on socket: " + socket_path;
+        return false;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    listen_fd_ = fd;
+    path_ = socket_path;
+    return true;
+}
+
+bool ConfigServer::publish(const Config &cfg, std::string &err) {
+    auto image = std::make_shared<const std::string>(ConfigImage::build(cfg));
+    if (image->empty()) {
+        err = "Config too large to serve";
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        image_ = std::move(image);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    wake();
+    return true;
+}
+
+void ConfigServer::stop() {
+    stop_.store(true);
+    wake();
+}
+
+// Interrupt poll() in run(). Only write(), so it is async-signal-safe.
+void ConfigServer::wake() {
+    char c = 0;
+    ssize_t ignored = ::write(wake_fds_[1], &c, 1);
+    (void)ignored;
+}
+
+// Answer every complete frame in conn.in.
+void ConfigServer::handle(Connection &conn, const std::string &image_bytes, uint64_t generation) {
+    ConfigImage image = ConfigImage::view(image_bytes.data(), image_bytes.size());
+    size_t pos = 0;
+    while (!conn.closing && conn.in.size() - pos >= 4) {
+        uint32_t len = getU32(conn.in.data() + pos);
+        if (len < kFrameHeader - 4 || len > kMaxFrame) {
+            size_t start = beginFrame(conn.out, 'X', 0);
+            conn.out += "bad frame length";
+            finishFrame(conn.out, start);
+            conn.closing = true;
+            break;
+        }
+        if (conn.in.size() - pos - 4 < len) break;
+        char op = conn.in[pos + 4];
+        uint32_t id = getU32(conn.in.data() + pos + 5);
+        std::string payload = conn.in.substr(pos + kFrameHeader, len - (kFrameHeader - 4));
+        pos += 4 + len;
+
+        if (op == 'G') {
+            bool ok = payload.size() >= 4;
+            uint32_t count = ok ? getU32(payload.data()) : 0;
+            size_t p = 4;
+            size_t start = beginFrame(conn.out, 'V', id);
+            putU64(conn.out, generation);
+            putU32(conn.out, count);
+            for (uint32_t i = 0; ok && i < count; ++i) {
+                std::string_view section, key, value;
+                ok = getString(payload, p, section) && getString(payload, p, key);
+                bool found = ok && image.find(section, key, value);
+                conn.out.push_back(found ? 1 : 0);
+                putU32(conn.out, static_cast<uint32_t>(value.size()));
+                conn.out.append(value.data(), value.size());
+            }
+            if (!ok) {
+                conn.out.resize(start);
+                start = beginFrame(conn.out, 'X', id);
+                conn.out += "malformed get request";
+                conn.closing = true;
+            }
+            finishFrame(conn.out, start);
+        } else if (op == 'S') {
+            conn.subscribed = true;
+            size_t start = beginFrame(conn.out, 'R', id);
+            putU64(conn.out, generation);
+            finishFrame(conn.out, start);
+        } else {
+            size_t start = beginFrame(conn.out, 'X', id);
+            conn.out += "unknown op";
+            finishFrame(conn.out, start);
+            conn.closing = true;
+        }
+    }
+    conn.in.erase(0, pos);
+}
+
+bool ConfigServer::run(std::string &err) {
+    if (listen_fd_ < 0 || wake_fds_[0] < 0) {
+        err = "Server is not listening";
+        return false;
+    }
+    uint64_t notified = generation();
+    std::vector<pollfd> fds;
+    char buf[64 * 1024];
+
+    while (!stop_.load()) {
+        fds.clear();
+        fds.push_back({wake_fds_[0], POLLIN, 0});
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (auto &conn : connections_) {
+            short events = 0;
+            if (!conn->closing && conn->out.size() - conn->out_pos < kMaxPendingOutput) events |= POLLIN;
+            if (conn->out_pos < conn->out.size()) events |= POLLOUT;
+            fds.push_back({conn->fd, events, 0});
+        }
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            err = "poll failed on socket: " + path_;
+            return false;
+        }
+        if (fds[0].revents) {
+            while (::read(wake_fds_[0], buf, sizeof(buf)) > 0) {
+            }
+        }
+
+        std::shared_ptr<const std::string> image;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            image = image_;
+            generation = generation_.load(std::memory_order_acquire);
+        }
+        static const std::string kEmpty = ConfigImage::build(Config());
+        const std::string &image_bytes = image ? *image : kEmpty;
+
+        for (size_t i = 0; i < connections_.size(); ++i) {
+            Connection &conn = *connections_[i];
+            short revents = fds[i + 2].revents;
+            if (revents & POLLIN) {
+                ssize_t n = ::recv(conn.fd, buf, sizeof(buf), 0);
+                if (n > 0) {
+                    conn.in.append(buf, static_cast<size_t>(n));
+                    handle(conn, image_bytes, generation);
+                } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+                    conn.closing = true;
+                    conn.out.clear();
+                    conn.out_pos = 0;
+                }
+            } else if (revents & (POLLHUP | POLLERR)) {
+                conn.closing = true;
+                conn.out.clear();
+                conn.out_pos = 0;
+            }
+        }
+
+        if (generation != notified) {
+            notified = generation;
+            for (auto &conn : connections_) {
+                if (!conn->subscribed || conn->closing) continue;
+                size_t start = beginFrame(conn->out, 'R', 0);
+                putU64(conn->out, generation);
+                finishFrame(conn->out, start);
+            }
+        }
+
+        // Flush pending answers and drop finished connections.
+        for (size_t i = 0; i < connections_.size();) {
+            Connection &conn = *connections_[i];
+            while (conn.out_pos < conn.out.size()) {
+                ssize_t w = ::send(conn.fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos,
+                                   kSendFlags);
+                if (w > 0) {
+                    conn.out_pos += static_cast<size_t>(w);
+                } else {
+                    if (w < 0 && errno == EINTR) continue;
+                    if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                        conn.closing = true;
+                        conn.out.clear();
+                        conn.out_pos = 0;
+                    }
+                    break;
+                }
+            }
+            if (conn.out_pos == conn.out.size()) {
+                conn.out.clear();
+                conn.out_pos = 0;
+            }
+            if (conn.closing && conn.out.empty()) {
+                ::close(conn.fd);
+                connections_.erase(connections_.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            for (;;) {
+                int fd = ::accept(listen_fd_, nullptr, nullptr);
+                if (fd < 0) break;
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+                connections_.push_back(std::unique_ptr<Connection>(new Connection(fd)));
+            }
+        }
+    }
+    return true;
+}
+
+ConfigClient::~ConfigClient() {
+    close();
+}
+
+bool ConfigClient::connect(const std::string &socket_path, std::string &err) {
+    close();
+    sockaddr_un addr;
+    if (!socketAddress(socket_path, addr, err)) return false;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) ::close(fd);
+        err = "Could not connect to config server: " + socket_path;
+        return false;
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fd_ = fd;
+    return true;
+}
+
+void ConfigClient::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    in_.clear();
+    reloads_.clear();
+}
+
+bool ConfigClient::send(const std::vector<Key> &keys, uint32_t &id, std::string &err) {
+    if (fd_ < 0) {
+        err = "Not connected";
+        return false;
+    }
+    std::string frame;
+    id = next_id_++;
+    size_t start = beginFrame(frame, 'G', id);
+    putU32(frame, static_cast<uint32_t>(keys.size()));
+    for (const Key &k : keys) {
+        putU32(frame, static_cast<uint32_t>(k.first.size()));
+        frame += k.first;
+        putU32(frame, static_cast<uint32_t>(k.second.size()));
+        frame += k.second;
+    }
+    finishFrame(frame, start);
+    if (frame.size() - 4 > kMaxFrame) {
+        err = "Request too large";
+        return false;
+    }
+    if (!sendAll(fd_, frame.data(), frame.size())) {
+        err = "Could not send to config server";
+        return false;
+    }
+    return true;
+}
+
+// Read one frame. Returns false on timeout (err empty) or failure (err set).
+bool ConfigClient::readFrame(char &op, uint32_t &id, std::string &payload, std::string &err, int timeout_ms) {
+    if (fd_ < 0) {
+        err = "Not connected";
+        return false;
+    }
+    for (;;) {
+        if (in_.size() >= kFrameHeader) {
+            uint32_t len = getU32(in_.data());
+            if (len < kFrameHeader - 4 || len > kMaxFrame) {
+                err = "Malformed frame from config server";
+                return false;
+            }
+            if (in_.size() - 4 >= len) {
+                op = in_[4];
+                id = getU32(in_.data() + 5);
+                payload.assign(in_, kFrameHeader, len - (kFrameHeader - 4));
+                in_.erase(0, 4 + len);
+                return true;
+            }
+        }
+        if (timeout_ms >= 0) {
+            pollfd p{fd_, POLLIN, 0};
+            int r = ::poll(&p, 1, timeout_ms);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) {
+                err = "Could not poll connection to config server";
+                return false;
+            }
+            if (r == 0) return false;
+        }
+        char buf[64 * 1024];
+        ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            err = "Connection to config server closed";
+            return false;
+        }
+        in_.append(buf, static_cast<size_t>(n));
+    }
+}
+
+// Read frames until an answer of the expected op arrives, queueing reload events.
+bool ConfigClient::readAnswer(char expected, uint32_t &id, std::string &payload, std::string &err) {
+    for (;;) {
+        char op;
+        if (!readFrame(op, id, payload, err, -1)) return false;
+        if (op == 'X') {
+            err = "Config server error: " + payload;
+            return false;
+        }
+        if (op == 'R' && !(expected == 'R' && id != 0)) {
+            if (payload.size() >= 8) reloads_.push_back(getU64(payload.data()));
+            continue;
+        }
+        if (op != expected) {
+            err = "Unexpected answer from config server";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool ConfigClient::receive(uint32_t &id, Values &values, std::string &err) {
+    std::string payload;
+    if (!readAnswer('V', id, payload, err)) return false;
+    if (payload.size() < 12) {
+        err = "Malformed answer from config server";
+        return false;
+    }
+    generation_ = getU64(payload.data());
+    uint32_t count = getU32(payload.data() + 8);
+    values.clear();
+    size_t pos = 12;
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string_view value;
+        if (payload.size() - pos < 1) break;
+        bool found = payload[pos++] != 0;
+        if (!getString(payload, pos, value)) break;
+        if (found) values.emplace_back(std::string(value));
+        else values.emplace_back();
+    }
+    if (values.size() != count) {
+        err = "Malformed answer from config server";
+        return false;
+    }
+    return true;
+}
+
+bool ConfigClient::get(const std::vector<Key> &keys, Values &values, std::string &err) {
+    uint32_t id;
+    return send(keys, id, err) && receive(id, values, err);
+}
+
+std::string ConfigClient::get(const std::string &section, const std::string &key, const std::string &default_val) {
+    Values values;
+    std::string err;
+    if (!get({Key(section, key)}, values, err) || values.empty() || !values[0]) return default_val;
+    return *values[0];
+}
+
+bool ConfigClient::subscribe(std::string &err) {
+    if (fd_ < 0) {
+        err = "Not connected";
+        return false;
+    }
+    std::string frame;
+    size_t start = beginFrame(frame, 'S', next_id_++);
+    finishFrame(frame, start);
+    if (!sendAll(fd_, frame.data(), frame.size())) {
+        err = "Could not send to config server";
+        return false;
+    }
+    uint32_t id;
+    std::string payload;
+    if (!readAnswer('R', id, payload, err)) return false;
+    if (payload.size() >= 8) generation_ = getU64(payload.data());
+    return true;
+}
+
+bool ConfigClient::waitReload(uint64_t &generation, std::string &err, int timeout_ms) {
+    while (reloads_.empty()) {
+        char op;
+        uint32_t id;
+        std::string payload;
+        if (!readFrame(op, id, payload, err, timeout_ms)) return false;
+        if (op == 'X') {
+            err = "Config server error: " + payload;
+            return false;
+        }
+        if (op == 'R' && payload.size() >= 8) reloads_.push_back(getU64(payload.data()));
+    }
+    generation = generation_ = reloads_.front();
+    reloads_.pop_front();
+    return true;
+}
@@ -0,0 +1,211 @@
+// Shared memory publishing of ConfigImages.
+//
+// The control segment holds a magic and an atomic generation counter. The
+// publisher creates "<name>.<generation>", fills it, then stores the new
+// generation with release ordering; a reader loads it with acquire ordering,
+// so once it sees a generation the segment contents are complete. A reader
+// that loses the race against the unlink of an old segment simply re-reads
+// the generation and maps the newer one.
+
+#include "iniparsercxx_shm.hpp"
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kControlMagic[8] = {'I', 'N', 'I', 'S', 'H', 'M', '1', '\0'};
+
+struct Control {
+    char magic[8];
+    std::atomic<uint64_t> generation;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "generation counter must be lock-free across processes");
+
+std::string segmentName(const std::string &name, uint64_t generation) {
+    return name + "." + std::to_string(generation);
+}
+
+} // namespace
+
+SharedConfigPublisher::SharedConfigPublisher(std::string name, unsigned mode)
+    : name_(std::move(name)), mode_(mode) {}
+
+SharedConfigPublisher::~SharedConfigPublisher() {
+    if (control_) ::munmap(control_, sizeof(Control));
+}
+
+// Create or open the control segment and continue from its generation, so a
+// restarted publisher never reuses a generation number readers have seen.
+bool SharedConfigPublisher::openControl(std::string &err) {
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT, mode_);
+    // shm_open masks the mode with the umask and keeps it for an existing segment
+    if (fd < 0 || ::fchmod(fd, mode_) != 0) {
+        if (fd >= 0) ::close(fd);
+        err = "Could not open shared memory: " + name_;
+        return false;
+    }
+    struct stat st;
+    bool fresh = ::fstat(fd, &st) == 0 && st.st_size == 0;
+    if (fresh && ::ftruncate(fd, sizeof(Control)) != 0) {
+        ::close(fd);
+        err = "Could not size shared memory: " + name_;
+        return false;
+    }
+    void *p = ::mmap(nullptr, sizeof(Control), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err = "Could not map shared memory: " + name_;
+        return false;
+    }
+    Control *control = static_cast<Control *>(p);
+    if (fresh || std::memcmp(control->magic, kControlMagic, sizeof(kControlMagic)) != 0) {
+        new (&control->generation) std::atomic<uint64_t>(0);
+        std::memcpy(control->magic, kControlMagic, sizeof(kControlMagic));
+    }
+    control_ = p;
+    generation_ = control->generation.load(std::memory_order_acquire);
+    return true;
+}
+
+bool SharedConfigPublisher::publish(const Config &cfg, std::string &err,
+                                    const std::vector<LookupProfiler::KeyCount> &hot) {
+    if (!control_ && !openControl(err)) return false;
+
+    std::string image = ConfigImage::build(cfg, hot);
+    if (image.empty()) {
+        err = "Config too large for a shared image";
+        return false;
+    }
+    uint64_t next = generation_ + 1;
+    std::string segment = segmentName(name_, next);
+    ::shm_unlink(segment.c_str()); // leftover from a crashed publisher
+    int fd = ::shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, mode_);
+    if (fd < 0 || ::fchmod(fd, mode_) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+            ::shm_unlink(segment.c_str());
+        }
+        err = "Could not create shared memory: " + segment;
+        return false;
+    }
+    void *p = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(image.size())) == 0)
+        p = ::mmap(nullptr, image.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        ::shm_unlink(segment.c_str());
+        err = "Could not map shared memory: " + segment;
+        return false;
+    }
+    std::memcpy(p, image.data(), image.size());
+    ::munmap(p, image.size());
+
+    static_cast<Control *>(control_)->generation.store(next, std::memory_order_release);
+    if (generation_) ::shm_unlink(segmentName(name_, generation_).c_str());
+    generation_ = next;
+    return true;
+}
+
+void SharedConfigPublisher::remove(const std::string &name) {
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+        void *p = ::mmap(nullptr, sizeof(Control), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p != MAP_FAILED) {
+            uint64_t generation = static_cast<Control *>(p)->generation.load(std::memory_order_acquire);
+            if (generation) ::shm_unlink(segmentName(name, generation).c_str());
+            ::munmap(p, sizeof(Control));
+        }
+    }
+    ::shm_unlink(name.c_str());
+}
+
+SharedConfigReader::SharedConfigReader(std::string name) : name_(std::move(name)) {}
+
+SharedConfigReader::~SharedConfigReader() {
+    unmap();
+    if (control_) ::munmap(control_, sizeof(Control));
+}
+
+bool SharedConfigReader::attach(std::string &err) {
+    if (!control_) {
+        int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            err = "No config published under: " + name_;
+            return false;
+        }
+        void *p = ::mmap(nullptr, sizeof(Control), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            err = "Could not map shared memory: " + name_;
+            return false;
+        }
+        control_ = p;
+    }
+    refresh();
+    if (!generation_) {
+        err = "No config published under: " + name_;
+        return false;
+    }
+    return true;
+}
+
+bool SharedConfigReader::refresh() {
+    if (!control_) return false;
+    const Control *control = static_cast<const Control *>(control_);
+    // a few attempts cover generations unlinked between the load and shm_open
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        uint64_t g = control->generation.load(std::memory_order_acquire);
+        if (g == generation_ || g == 0) return false;
+        if (map(g)) return true;
+    }
+    return false;
+}
+
+bool SharedConfigReader::map(uint64_t generation) {
+    int fd = ::shm_open(segmentName(name_, generation).c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    void *p = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    ConfigImage image = ConfigImage::view(p, static_cast<size_t>(st.st_size));
+    if (!image.valid()) {
+        ::munmap(p, static_cast<size_t>(st.st_size));
+        return false;
+    }
+    unmap();
+    data_ = p;
+    size_ = static_cast<size_t>(st.st_size);
+    image_ = image;
+    generation_ = generation;
+    return true;
+}
+
+void SharedConfigReader::unmap() {
+    if (data_) ::munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    image_ = ConfigImage();
+}
+
+bool SharedConfigReader::find(std::string_view section, std::string_view key, std::string_view &value) {
+    refresh();
+    return image_.find(section, key, value);
+}
+
+std::string SharedConfigReader::get(const std::string &section, const std::string &key,
+                                    const std::string &default_val) {
+    std::string_view value;
+    if (!find(section, key, value)) return default_val;
+    return std::string(value);
+}
@@ -0,0 +1,157 @@
+#include <iniparsercxx_compress.hpp>
+#include <iniparsercxx.hpp>
+#include <iniparsercxx_metrics.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static std::string readAll(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+static void expectSmallConfig(const Config &config) {
+    EXPECT_EQ(config.get("", "top"), "level");
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+    EXPECT_EQ(config.get("section1", "port"), "8080");
+    EXPECT_EQ(config.get("section2", "user"), "admin");
+}
+
+// Test format detection by magic bytes
+TEST(CompressedFileTest, Detect) {
+    EXPECT_EQ(CompressedFile::detect(std::string("\x1f\x8b\x08\x00", 4)), CompressedFile::Format::Gzip);
+    EXPECT_EQ(CompressedFile::detect(std::string("\x28\xb5\x2f\xfd", 4)), CompressedFile::Format::Zstd);
+    EXPECT_EQ(CompressedFile::detect("[section]\nkey=value\n"), CompressedFile::Format::Plain);
+    EXPECT_EQ(CompressedFile::detect(""), CompressedFile::Format::Plain);
+    EXPECT_TRUE(CompressedFile::supported(CompressedFile::Format::Plain));
+}
+
+// Test that plain files load through the same path
+TEST(CompressedFileTest, PlainFile) {
+    Config config;
+    std::string err;
+    ASSERT_TRUE(CompressedFile::load(config, "test_valid.ini", err)) << "Error: " << err;
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+    EXPECT_EQ(config.get("section2", "password"), "secret123");
+
+    EXPECT_FALSE(CompressedFile::load(config, "nonexistent.ini.gz", err));
+    EXPECT_EQ(err, "Could not open config file: nonexistent.ini.gz");
+}
+
+// Test that a failed open clears the config and reports the path
+TEST(CompressedFileTest, MissingFileClearsConfig) {
+    Config config;
+    std::string err;
+    auto metrics = std::make_shared<ConfigMetrics>();
+    config.setMetrics(metrics);
+    ASSERT_TRUE(CompressedFile::load(config, "test_valid.ini", err)) << "Error: " << err;
+    ASSERT_FALSE(config.sections().empty());
+
+    EXPECT_FALSE(CompressedFile::load(config, "nonexistent.ini.gz", err));
+    EXPECT_EQ(err, "Could not open config file: nonexistent.ini.gz");
+    EXPECT_TRUE(config.sections().empty());
+    EXPECT_EQ(config.get("section1", "host", "default"), "default");
+    EXPECT_EQ(metrics->totals().loads, 2u);
+    EXPECT_EQ(metrics->totals().load_failures, 1u);
+
+    ParseLimits limits;
+    limits.max_total_bytes = 16;
+    EXPECT_FALSE(CompressedFile::load(config, "test_valid.ini", err, limits));
+    EXPECT_EQ(err, "Config input is larger than 16 bytes: test_valid.ini");
+}
+
+// Test loading gzip and zstd files, or the error when support is not built in
+TEST(CompressedFileTest, LoadCompressed) {
+    for (const char *path : {"test_compressed.ini.gz", "test_compressed.ini.zst"}) {
+        Config config;
+        std::string err;
+        CompressedFile::Format format = CompressedFile::detect(readAll(path));
+        EXPECT_NE(format, CompressedFile::Format::Plain) << path;
+        if (!CompressedFile::supported(format)) {
+            EXPECT_FALSE(CompressedFile::load(config, path, err)) << path;
+            EXPECT_NE(err.find("support is not built in"), std::string::npos) << err;
+            continue;
+        }
+        ASSERT_TRUE(CompressedFile::load(config, path, err)) << path << ": " << err;
+        expectSmallConfig(config);
+    }
+}
+
+// Test concatenated members spanning many input and output blocks
+TEST(CompressedFileTest, ConcatenatedMembers) {
+    if (!CompressedFile::supported(CompressedFile::Format::Gzip)) GTEST_SKIP() << "gzip support not built in";
+    const std::string member = readAll("test_compressed.ini.gz");
+    {
+        std::ofstream ofs("test_compress_many.ini.gz", std::ios::binary);
+        for (int i = 0; i < 4000; ++i) ofs << member;
+    }
+
+    CompressedFile file;
+    std::string err;
+    ASSERT_TRUE(file.open("test_compress_many.ini.gz", err)) << "Error: " << err;
+    EXPECT_EQ(file.format(), CompressedFile::Format::Gzip);
+    std::string text;
+    char buf[1000];
+    size_t got = 0;
+    do {
+        ASSERT_TRUE(file.read(buf, sizeof(buf), got, err)) << "Error: " << err;
+        text.append(buf, got);
+    } while (got > 0);
+    EXPECT_EQ(file.compressedBytes(), member.size() * 4000);
+    const std::string once = text.substr(0, text.size() / 4000);
+    EXPECT_EQ(text.size(), once.size() * 4000);
+    EXPECT_EQ(text.substr(text.size() - once.size()), once);
+
+    Config config;
+    ASSERT_TRUE(CompressedFile::load(config, "test_compress_many.ini.gz", err)) << "Error: " << err;
+    expectSmallConfig(config);
+}
+
+// Test that truncated and corrupt input fails instead of loading partial data
+TEST(CompressedFileTest, TruncatedAndCorrupt) {
+    if (!CompressedFile::supported(CompressedFile::Format::Gzip)) GTEST_SKIP() << "gzip support not built in";
+    const std::string gz = readAll("test_compressed.ini.gz");
+    std::ofstream("test_compress_truncated.ini.gz", std::ios::binary) << gz.substr(0, gz.size() - 12);
+    std::string corrupt = gz;
+    corrupt[gz.size() / 2] ^= 0x55;
+    std::ofstream("test_compress_corrupt.ini.gz", std::ios::binary) << corrupt;
+
+    Config config;
+    std::string err;
+    EXPECT_FALSE(CompressedFile::load(config, "test_compress_truncated.ini.gz", err));
+    EXPECT_EQ(err, "Truncated gzip config file: test_compress_truncated.ini.gz");
+    EXPECT_FALSE(CompressedFile::load(config, "test_compress_corrupt.ini.gz", err));
+    EXPECT_EQ(err, "Corrupt gzip config file: test_compress_corrupt.ini.gz");
+}
+
+// Test Config::loadFromStream with tiny blocks that split every line
+TEST(CompressedFileTest, LoadFromStream) {
+    const std::string text = "a=1\n[s]\nb = 2 ; c\nno equals\nlast=x";
+    size_t pos = 0;
+    Config config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromStream(
+        [&](char *buf, size_t size, size_t &got, std::string &) {
+            got = std::min<size_t>({size, 3, text.size() - pos});
+            text.copy(buf, got, pos);
+            pos += got;
+            return true;
+        },
+        err));
+    EXPECT_EQ(config.get("", "a"), "1");
+    EXPECT_EQ(config.get("s", "b"), "2");
+    EXPECT_EQ(config.get("s", "last"), "x");
+
+    EXPECT_FALSE(config.loadFromStream(
+        [](char *, size_t, size_t &, std::string &e) {
+            e = "boom";
+            return false;
+        },
+        err));
+    EXPECT_EQ(err, "boom");
+    EXPECT_EQ(config.section("s"), nullptr);
+}
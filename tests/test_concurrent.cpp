@@ -0,0 +1,152 @@
+#include <iniparsercxx_concurrent.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test loading, reading and writing
+TEST(ConcurrentConfigTest, SetGetErase) {
+    ConcurrentConfig config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+    EXPECT_EQ(config.get("section1", "missing", "default"), "default");
+
+    config.set("section1", "host", "example.org");
+    config.set("new", "key", "value");
+    EXPECT_EQ(config.get("section1", "host"), "example.org");
+    EXPECT_EQ(config.get("new", "key"), "value");
+
+    EXPECT_TRUE(config.erase("new", "key"));
+    EXPECT_FALSE(config.erase("new", "key"));
+    EXPECT_EQ(config.get("new", "key", "gone"), "gone");
+
+    // A failed load keeps the current contents
+    EXPECT_FALSE(config.loadFromFile("nonexistent.ini", err));
+    EXPECT_EQ(config.get("section1", "host"), "example.org");
+}
+
+// Test that snapshots are isolated from later writes
+TEST(ConcurrentConfigTest, SnapshotIsolation) {
+    Config base;
+    std::string err;
+    ASSERT_TRUE(base.loadFromFile("test_valid.ini", err));
+    ConcurrentConfig config(base);
+
+    Config snap = config.snapshot();
+    config.set("section2", "user", "root");
+    config.erase("section1", "port");
+
+    EXPECT_EQ(snap.get("section2", "user"), "admin");
+    EXPECT_EQ(snap.get("section1", "port"), "8080");
+    EXPECT_EQ(config.get("section2", "user"), "root");
+    EXPECT_EQ(config.get("section1", "port", "gone"), "gone");
+    EXPECT_EQ(base.get("section2", "user"), "admin");
+}
+
+// Test readers and writers running at the same time
+TEST(ConcurrentConfigTest, ConcurrentReadersAndWriters) {
+    ConcurrentConfig config;
+    for (int s = 0; s < 8; ++s) config.set("s" + std::to_string(s), "k", "0");
+
+    std::atomic<bool> bad{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        // writer t owns section s<t> and counts upwards
+        threads.emplace_back([&, t] {
+            std::string section = "s" + std::to_string(t);
+            for (int i = 1; i <= 2000; ++i) config.set(section, "k", std::to_string(i));
+        });
+        // reader t checks that values in its section never go backwards
+        threads.emplace_back([&, t] {
+            std::string section = "s" + std::to_string(t);
+            int last = 0;
+            for (int i = 0; i < 2000; ++i) {
+                int v = std::stoi(config.get(section, "k"));
+                if (v < last) bad = true;
+                last = v;
+                if (i % 100 == 0) config.snapshot();
+            }
+        });
+    }
+    for (auto &th : threads) th.join();
+    EXPECT_FALSE(bad);
+    for (int t = 0; t < 4; ++t) EXPECT_EQ(config.get("s" + std::to_string(t), "k"), "2000");
+    EXPECT_EQ(config.get("s7", "k"), "0");
+}
+
+// Test staging and committing a batch
+TEST(ConcurrentConfigTest, TransactionCommit) {
+    ConcurrentConfig config;
+    config.set("a", "x", "old");
+    config.set("b", "y", "old");
+
+    auto tx = config.transaction();
+    tx.set("a", "x", "new");
+    tx.erase("b", "y");
+    tx.set("c", "z", "1");
+    tx.set("c", "z", "2");
+    EXPECT_EQ(tx.size(), 4u);
+
+    // Nothing is visible before commit
+    EXPECT_EQ(config.get("a", "x"), "old");
+    EXPECT_EQ(config.get("c", "z", "none"), "none");
+
+    Config before = config.snapshot();
+    tx.commit();
+    EXPECT_EQ(tx.size(), 0u);
+    EXPECT_EQ(before.get("a", "x"), "old");
+    EXPECT_EQ(before.get("b", "y"), "old");
+    EXPECT_EQ(config.get("a", "x"), "new");
+    EXPECT_EQ(config.get("b", "y", "gone"), "gone");
+    EXPECT_EQ(config.get("c", "z"), "2");
+}
+
+// Test that a commit copies only the sections it writes to
+TEST(ConcurrentConfigTest, TransactionKeepsUntouchedSections) {
+    ConcurrentConfig config;
+    for (int i = 0; i < 64; ++i) config.set("s" + std::to_string(i), "k", "v");
+    Config before = config.snapshot();
+
+    auto tx = config.transaction();
+    tx.set("s0", "k", "new");
+    tx.erase("s1", "k");
+    tx.commit();
+
+    Config after = config.snapshot();
+    EXPECT_NE(after.section("s0"), before.section("s0"));
+    EXPECT_EQ(after.section("s1"), nullptr);
+    EXPECT_EQ(before.get("s0", "k"), "v");
+    for (int i = 2; i < 64; ++i) {
+        std::string name = "s" + std::to_string(i);
+        EXPECT_EQ(after.section(name), before.section(name)) << name;
+    }
+}
+
+// Test that snapshots never see a partially applied batch
+TEST(ConcurrentConfigTest, TransactionAtomicity) {
+    ConcurrentConfig config;
+    const int kKeys = 16;
+    for (int k = 0; k < kKeys; ++k) config.set("s" + std::to_string(k), "k", "0");
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    std::thread reader([&] {
+        while (!done) {
+            Config snap = config.snapshot();
+            std::string first = snap.get("s0", "k");
+            for (int k = 1; k < kKeys; ++k)
+                if (snap.get("s" + std::to_string(k), "k") != first) torn = true;
+        }
+    });
+    for (int i = 1; i <= 300; ++i) {
+        auto tx = config.transaction();
+        for (int k = 0; k < kKeys; ++k) tx.set("s" + std::to_string(k), "k", std::to_string(i));
+        tx.commit();
+    }
+    done = true;
+    reader.join();
+    EXPECT_FALSE(torn);
+    EXPECT_EQ(config.get("s15", "k"), "300");
+}
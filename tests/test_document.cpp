@@ -0,0 +1,113 @@
+#include <iniparsercxx_document.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+static const char *kSource =
+    "; service config\n"
+    "name = demo   ; display name\n"
+    "\n"
+    "[db]\n"
+    "host = localhost  # primary\n"
+    "port=5432\n"
+    "\n"
+    "# trailing comment\n"
+    "[cache]\n"
+    "size = 64\n";
+
+static std::string readAll(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+// Test that an untouched document renders byte for byte
+TEST(IniDocumentTest, LosslessRoundTrip) {
+    IniDocument doc;
+    doc.parse(kSource);
+    EXPECT_EQ(doc.text(), kSource);
+    EXPECT_EQ(doc.pendingEdits(), 0u);
+    EXPECT_EQ(doc.get("db", "host"), "localhost");
+    EXPECT_EQ(doc.get("", "name"), "demo");
+}
+
+// Test that edits keep comments and layout
+TEST(IniDocumentTest, SpliceEdits) {
+    IniDocument doc;
+    doc.parse(kSource);
+    doc.set("db", "host", "db.example.org");
+    doc.set("db", "user", "app");
+    EXPECT_TRUE(doc.erase("cache", "size"));
+    EXPECT_FALSE(doc.erase("cache", "size"));
+    doc.set("new", "flag", "on");
+
+    EXPECT_EQ(doc.text(),
+              "; service config\n"
+              "name = demo   ; display name\n"
+              "\n"
+              "[db]\n"
+              "host = db.example.org  # primary\n"
+              "port=5432\n"
+              "user=app\n"
+              "\n"
+              "# trailing comment\n"
+              "[cache]\n"
+              "\n"
+              "[new]\n"
+              "flag=on\n");
+    EXPECT_EQ(doc.get("db", "user"), "app");
+    EXPECT_EQ(doc.get("cache", "size", "gone"), "gone");
+}
+
+// Test edits on a file without a final newline
+TEST(IniDocumentTest, NoTrailingNewline) {
+    IniDocument doc;
+    doc.parse("[a]\nx=1");
+    doc.set("a", "y", "2");
+    doc.set("", "top", "0");
+    EXPECT_EQ(doc.text(), "top=0\n[a]\nx=1\ny=2\n");
+}
+
+// Test same-size edits written in place and resized edits rewritten
+TEST(IniDocumentTest, SaveInPlaceAndRewrite) {
+    std::ofstream("test_document.ini", std::ios::binary) << kSource;
+    IniDocument doc;
+    std::string err;
+    ASSERT_TRUE(doc.load("test_document.ini", err)) << "Error: " << err;
+
+    doc.set("db", "port", "6543");
+    ASSERT_TRUE(doc.save("test_document.ini", err)) << "Error: " << err;
+    std::string expected = kSource;
+    expected.replace(expected.find("5432"), 4, "6543");
+    EXPECT_EQ(readAll("test_document.ini"), expected);
+    EXPECT_EQ(doc.pendingEdits(), 0u);
+
+    doc.set("cache", "size", "128");
+    ASSERT_TRUE(doc.save("test_document.ini", err)) << "Error: " << err;
+    expected.replace(expected.find("size = 64"), 9, "size = 128");
+    EXPECT_EQ(readAll("test_document.ini"), expected);
+    EXPECT_EQ(doc.get("cache", "size"), "128");
+
+    EXPECT_FALSE(doc.load("nonexistent.ini", err));
+}
+
+// Test that entries which would not read back are rejected
+TEST(IniDocumentTest, SetRejectsUnreadable) {
+    IniDocument doc;
+    doc.parse(kSource);
+    EXPECT_FALSE(doc.set("db", "host", "a;b"));
+    EXPECT_FALSE(doc.set("db", "host", "a#b"));
+    EXPECT_FALSE(doc.set("db", "a=b", "1"));
+    EXPECT_FALSE(doc.set("db", "key", "two\nlines"));
+    EXPECT_FALSE(doc.set("d]b", "key", "1"));
+    EXPECT_FALSE(doc.set("db", "k]", "1"));
+    EXPECT_FALSE(doc.set("db", "key", "x]"));
+    EXPECT_EQ(doc.text(), kSource);
+    EXPECT_EQ(doc.get("db", "host"), "localhost");
+
+    // top-level keys of an empty document need no header
+    IniDocument empty;
+    EXPECT_TRUE(empty.set("", "top", "1"));
+    EXPECT_TRUE(empty.set("s", "k", "v"));
+    EXPECT_EQ(empty.text(), "top=1\n[s]\nk=v\n");
+}
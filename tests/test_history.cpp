@@ -0,0 +1,81 @@
+#include <iniparsercxx_history.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+// Build a config with sections s0..s9 holding keys k0..k99
+static Config makeConfig() {
+    Config cfg;
+    for (int s = 0; s < 10; ++s)
+        for (int k = 0; k < 100; ++k)
+            cfg.set("s" + std::to_string(s), "k" + std::to_string(k), "v" + std::to_string(k));
+    return cfg;
+}
+
+// Test querying and checking out older versions
+TEST(ConfigHistoryTest, QueryVersions) {
+    ConfigHistory history;
+    Config cfg;
+    std::string err;
+    ASSERT_TRUE(cfg.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    uint64_t v1 = history.commit(cfg);
+
+    cfg.set("section1", "host", "example.org");
+    cfg.erase("section2", "password");
+    cfg.set("section3", "new", "1");
+    uint64_t v2 = history.commit(cfg);
+
+    EXPECT_EQ(v1, 1u);
+    EXPECT_EQ(v2, 2u);
+    EXPECT_EQ(history.get(v1, "section1", "host"), "localhost");
+    EXPECT_EQ(history.get(v2, "section1", "host"), "example.org");
+    EXPECT_EQ(history.get(v1, "section2", "password"), "secret123");
+    EXPECT_EQ(history.get(v2, "section2", "password", "gone"), "gone");
+    EXPECT_EQ(history.get(v1, "section3", "new", "none"), "none");
+    EXPECT_EQ(history.get(v2, "section3", "new"), "1");
+    EXPECT_EQ(history.get(v2, "", "key1"), "value1");
+
+    Config rolled;
+    ASSERT_TRUE(history.checkout(v1, rolled));
+    EXPECT_EQ(rolled.get("section1", "host"), "localhost");
+    EXPECT_EQ(rolled.get("section2", "password"), "secret123");
+    EXPECT_EQ(rolled.section("section3"), nullptr);
+    EXPECT_FALSE(history.checkout(99, rolled));
+}
+
+// Test that only the last N versions are kept
+TEST(ConfigHistoryTest, Retention) {
+    ConfigHistory history(3);
+    Config cfg;
+    for (int i = 1; i <= 5; ++i) {
+        cfg.set("", "rev", std::to_string(i));
+        history.commit(cfg);
+    }
+    EXPECT_EQ(history.size(), 3u);
+    EXPECT_EQ(history.oldest(), 3u);
+    EXPECT_EQ(history.latest(), 5u);
+    EXPECT_FALSE(history.contains(2));
+    EXPECT_EQ(history.get(2, "", "rev", "evicted"), "evicted");
+    EXPECT_EQ(history.get(4, "", "rev"), "4");
+}
+
+// Test that a reload with one change only adds the changed path
+TEST(ConfigHistoryTest, StructuralSharing) {
+    ConfigHistory history;
+    history.commit(makeConfig());
+    size_t base = history.nodeCount();
+
+    // A fresh config with the same content shares everything
+    history.commit(makeConfig());
+    EXPECT_EQ(history.nodeCount(), base);
+
+    Config changed = makeConfig();
+    changed.set("s3", "k42", "changed");
+    history.commit(changed);
+    size_t grown = history.nodeCount() - base;
+    EXPECT_GT(grown, 0u);
+    EXPECT_LT(grown, 16u);
+
+    EXPECT_EQ(history.get(2, "s3", "k42"), "v42");
+    EXPECT_EQ(history.get(3, "s3", "k42"), "changed");
+    EXPECT_EQ(history.get(3, "s9", "k99"), "v99");
+}
@@ -0,0 +1,85 @@
+#include <iniparsercxx_image.hpp>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Test that every entry of a loaded file is found in the image
+TEST(ConfigImageTest, BuildAndFind) {
+    Config config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+
+    std::string bytes = ConfigImage::build(config);
+    ConfigImage image = ConfigImage::view(bytes.data(), bytes.size());
+    ASSERT_TRUE(image.valid());
+
+    size_t entries = 0;
+    for (const std::string &name : config.sections()) {
+        for (const auto &kv : *config.section(name)) {
+            EXPECT_EQ(image.get(name, kv.first, "<missing>"), kv.second);
+            ++entries;
+        }
+    }
+    EXPECT_EQ(image.entries(), entries);
+    EXPECT_EQ(image.get("section1", "nokey", "default"), "default");
+    EXPECT_EQ(image.get("nosection", "host", "default"), "default");
+}
+
+// Test that the image holds no pointers: a copy at another address reads the same
+TEST(ConfigImageTest, Relocatable) {
+    Config config;
+    for (int i = 0; i < 500; ++i) config.set("s" + std::to_string(i % 7), "k" + std::to_string(i), std::to_string(i));
+
+    std::string bytes = ConfigImage::build(config);
+    std::vector<char> copy(bytes.begin(), bytes.end());
+    bytes.assign(bytes.size(), 'x');
+    ConfigImage image = ConfigImage::view(copy.data(), copy.size());
+    ASSERT_TRUE(image.valid());
+    EXPECT_EQ(image.entries(), 500u);
+    for (int i = 0; i < 500; ++i)
+        EXPECT_EQ(image.get("s" + std::to_string(i % 7), "k" + std::to_string(i)), std::to_string(i));
+    EXPECT_EQ(image.get("s0", "k1"), "");
+}
+
+// Test empty configs and rejected buffers
+TEST(ConfigImageTest, EmptyAndInvalid) {
+    std::string bytes = ConfigImage::build(Config());
+    ConfigImage image = ConfigImage::view(bytes.data(), bytes.size());
+    ASSERT_TRUE(image.valid());
+    EXPECT_EQ(image.entries(), 0u);
+    EXPECT_EQ(image.get("", "key", "default"), "default");
+
+    EXPECT_FALSE(ConfigImage::view(bytes.data(), bytes.size() - 1).valid());
+    std::string garbage(bytes.size(), 'x');
+    EXPECT_FALSE(ConfigImage::view(garbage.data(), garbage.size()).valid());
+}
+
+// Test that a profile-guided build keeps all entries and packs hot ones first
+TEST(ConfigImageTest, ProfileGuidedBuild) {
+    Config config;
+    for (int s = 0; s < 10; ++s)
+        for (int k = 0; k < 50; ++k) config.set("s" + std::to_string(s), "k" + std::to_string(k), "v" + std::to_string(s * 50 + k));
+
+    std::vector<LookupProfiler::KeyCount> hot = {{"s7", "k3", 100}, {"s2", "k40", 50}, {"nosection", "k", 10}};
+    std::string bytes = ConfigImage::build(config, hot);
+    ConfigImage image = ConfigImage::view(bytes.data(), bytes.size());
+    ASSERT_TRUE(image.valid());
+    EXPECT_EQ(image.entries(), 500u);
+
+    std::string_view first, second, value;
+    ASSERT_TRUE(image.find("s7", "k3", first));
+    ASSERT_TRUE(image.find("s2", "k40", second));
+    EXPECT_EQ(first, "v353");
+    EXPECT_EQ(second, "v140");
+    EXPECT_LT(first.data(), second.data());
+    for (int s = 0; s < 10; ++s) {
+        for (int k = 0; k < 50; ++k) {
+            ASSERT_TRUE(image.find("s" + std::to_string(s), "k" + std::to_string(k), value));
+            EXPECT_EQ(value, "v" + std::to_string(s * 50 + k));
+            if (value.data() != first.data() && value.data() != second.data()) {
+                EXPECT_GT(value.data(), second.data());
+            }
+        }
+    }
+}
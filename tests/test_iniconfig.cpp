@@ -1,6 +1,16 @@
 #include <iniparsercxx.hpp>
+#include <iniparsercxx_metrics.hpp>
 #include <gtest/gtest.h>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // Test fixture for Config tests
 class ConfigTest : public ::testing::Test {
@@ -201,3 +211,588 @@ TEST_F(ConfigTest, MultipleEqualsInValue) {
     // Note: semicolons are treated as comment markers, so using & instead
     EXPECT_EQ(config.get("", "connection"), "host=localhost&port=3306");
 }
+
+// Test pull parser events over an in-memory buffer
+TEST(IniReaderTest, EventsFromBuffer) {
+    const std::string text =
+        "; comment\n"
+        "top=1\n"
+        "[net]\n"
+        "host = example.org ; inline\n"
+        "garbage\n";
+    IniReader reader(text);
+    IniEvent ev;
+
+    ASSERT_TRUE(reader.next(ev));
+    EXPECT_EQ(ev.kind, IniEvent::Kind::KeyValue);
+    EXPECT_EQ(ev.section, "");
+    EXPECT_EQ(ev.key, "top");
+    EXPECT_EQ(ev.value, "1");
+    EXPECT_EQ(ev.line, 2u);
+
+    ASSERT_TRUE(reader.next(ev));
+    EXPECT_EQ(ev.kind, IniEvent::Kind::Section);
+    EXPECT_EQ(ev.section, "net");
+
+    ASSERT_TRUE(reader.next(ev));
+    EXPECT_EQ(ev.kind, IniEvent::Kind::KeyValue);
+    EXPECT_EQ(ev.section, "net");
+    EXPECT_EQ(ev.key, "host");
+    EXPECT_EQ(ev.value, "example.org");
+
+    ASSERT_TRUE(reader.next(ev));
+    EXPECT_EQ(ev.kind, IniEvent::Kind::Malformed);
+    EXPECT_EQ(ev.value, "garbage");
+    EXPECT_EQ(ev.line, 5u);
+
+    EXPECT_FALSE(reader.next(ev));
+}
+
+// Test iterating a file and stopping early
+TEST(IniReaderTest, IterateFileStopEarly) {
+    IniReader reader;
+    std::string err;
+    ASSERT_TRUE(reader.open("test_valid.ini", err)) << "Error: " << err;
+
+    std::string user;
+    size_t seen = 0;
+    for (const IniEvent &ev : reader) {
+        ++seen;
+        if (ev.section == "section2" && ev.key == "user") {
+            user = std::string(ev.value);
+            break;
+        }
+    }
+    EXPECT_EQ(user, "admin");
+    EXPECT_EQ(seen, 9u); // password line is never tokenized
+}
+
+// Test opening a missing file through the reader
+TEST(IniReaderTest, OpenNonExistentFile) {
+    IniReader reader;
+    std::string err;
+    EXPECT_FALSE(reader.open("nonexistent.ini", err));
+    EXPECT_NE(err.find("Could not open"), std::string::npos);
+}
+
+// Test push parser with input split at every possible chunk size
+TEST(IniPushParserTest, ChunkBoundaries) {
+    const std::string text =
+        "key1=value1\n"
+        "[section1]\n"
+        "host = localhost ; comment\n"
+        "bad line\n"
+        "[ section2 ]\r\n"
+        "name=test database";
+    for (size_t chunk = 1; chunk <= text.size(); ++chunk) {
+        IniPushParser parser;
+        for (size_t pos = 0; pos < text.size(); pos += chunk) {
+            parser.feed(std::string_view(text).substr(pos, chunk));
+        }
+        Config cfg = parser.finish();
+        EXPECT_EQ(cfg.get("", "key1"), "value1") << "chunk " << chunk;
+        EXPECT_EQ(cfg.get("section1", "host"), "localhost") << "chunk " << chunk;
+        EXPECT_EQ(cfg.get("section2", "name"), "test database") << "chunk " << chunk;
+    }
+}
+
+// Test that finish resets the parser for new input
+TEST(IniPushParserTest, FinishResets) {
+    IniPushParser parser;
+    parser.feed("[a]\nx=1\n");
+    EXPECT_EQ(parser.lines(), 2u);
+    Config first = parser.finish();
+    EXPECT_EQ(first.get("a", "x"), "1");
+
+    parser.feed("y=2");
+    Config second = parser.finish();
+    EXPECT_EQ(second.get("", "y"), "2");
+    EXPECT_EQ(second.get("a", "x"), "");
+}
+
+// Test single-key extraction without loading
+TEST(ConfigPeekTest, PeekValues) {
+    std::string value, err;
+    EXPECT_TRUE(Config::peek("test_valid.ini", "section2", "user", value, err));
+    EXPECT_EQ(value, "admin");
+    EXPECT_TRUE(Config::peek("test_valid.ini", "", "key2", value, err));
+    EXPECT_EQ(value, "value with spaces");
+    EXPECT_TRUE(Config::peek("test_whitespace.ini", "section1", "key3", value, err));
+    EXPECT_EQ(value, "value3");
+
+    err.clear();
+    EXPECT_FALSE(Config::peek("test_valid.ini", "section1", "user", value, err));
+    EXPECT_TRUE(err.empty());
+    EXPECT_FALSE(Config::peek("nonexistent.ini", "a", "b", value, err));
+    EXPECT_NE(err.find("Could not open"), std::string::npos);
+}
+
+// Test first-wins and last-wins lookups across repeated sections
+TEST(ConfigPeekTest, RepeatedSections) {
+    std::ofstream ofs("test_peek_repeat.ini");
+    ofs << "[a]\n";
+    ofs << "k=first\n";
+    ofs << "[b]\n";
+    ofs << "k=other [not a header]\n";
+    ofs << "  [a]  \n";
+    ofs << "k=second\n";
+    ofs.close();
+
+    std::string value, err;
+    ASSERT_TRUE(Config::peek("test_peek_repeat.ini", "a", "k", value, err));
+    EXPECT_EQ(value, "second");
+    ASSERT_TRUE(Config::peek("test_peek_repeat.ini", "a", "k", value, err, false));
+    EXPECT_EQ(value, "first");
+    ASSERT_TRUE(Config::peek("test_peek_repeat.ini", "b", "k", value, err));
+    EXPECT_EQ(value, "other [not a header]");
+}
+
+// Test lazy loading returns the same values as a full load
+TEST_F(ConfigTest, LazyMatchesFullLoad) {
+    Config full;
+    for (const char *file : {"test_valid.ini", "test_comments.ini", "test_whitespace.ini", "test_malformed.ini"}) {
+        ASSERT_TRUE(config.loadLazy(file, err)) << "Error: " << err;
+        ASSERT_TRUE(full.loadFromFile(file, err)) << "Error: " << err;
+        for (const char *section : {"", "section1", "section2", "database", "server", "missing"}) {
+            const Config::Section *expected = full.section(section);
+            const Config::Section *actual = config.section(section);
+            ASSERT_EQ(expected == nullptr, actual == nullptr) << file << " [" << section << "]";
+            if (expected) {
+                EXPECT_EQ(*expected, *actual) << file << " [" << section << "]";
+            }
+        }
+    }
+    EXPECT_FALSE(config.loadLazy("nonexistent.ini", err));
+    EXPECT_EQ(config.section("section1"), nullptr); // a failed load leaves the config empty
+}
+
+// Test lazy sections split across the file and empty sections
+TEST_F(ConfigTest, LazyRepeatedAndEmptySections) {
+    std::ofstream ofs("test_lazy.ini");
+    ofs << "top=1\n";
+    ofs << "[a]\n";
+    ofs << "x=1\n";
+    ofs << "[empty]\n";
+    ofs << "; nothing here\n";
+    ofs << "[a]\n";
+    ofs << "x=2\n";
+    ofs << "y=3\n";
+    ofs.close();
+
+    ASSERT_TRUE(config.loadLazy("test_lazy.ini", err));
+    EXPECT_EQ(config.get("", "top"), "1");
+    EXPECT_EQ(config.get("a", "x"), "2");
+    EXPECT_EQ(config.get("a", "y"), "3");
+    EXPECT_EQ(config.section("empty"), nullptr);
+    EXPECT_EQ(config.get("empty", "x", "default"), "default");
+
+    // A full load afterwards leaves lazy mode
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err));
+    EXPECT_EQ(config.get("a", "x"), "");
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+}
+
+// Test concurrent first access of lazily loaded sections
+TEST_F(ConfigTest, LazyConcurrentFirstTouch) {
+    ASSERT_TRUE(config.loadLazy("test_valid.ini", err));
+    std::vector<std::thread> threads;
+    std::vector<int> ok(8, 0);
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            ok[t] = config.get("section2", "user") == "admin" && config.get("section1", "port") == "8080";
+        });
+    }
+    for (auto &th : threads) th.join();
+    for (int v : ok) EXPECT_TRUE(v);
+}
+
+// Test loading a subset of sections by name
+TEST_F(ConfigTest, SectionFilterByName) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err, {"section2"})) << "Error: " << err;
+    EXPECT_EQ(config.get("section2", "user"), "admin");
+    EXPECT_EQ(config.get("section1", "host"), "");
+    EXPECT_EQ(config.get("", "key1"), "");
+    EXPECT_EQ(config.section("section1"), nullptr);
+
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err, {"", "section1"}));
+    EXPECT_EQ(config.get("", "key1"), "value1");
+    EXPECT_EQ(config.get("section1", "port"), "8080");
+    EXPECT_EQ(config.get("section2", "user"), "");
+}
+
+// Test loading a subset of sections by predicate
+TEST_F(ConfigTest, SectionFilterByPredicate) {
+    SectionFilter filter([](std::string_view s) { return s.substr(0, 7) == "section"; });
+    ASSERT_TRUE(config.loadFromFile("test_whitespace.ini", err, filter));
+    EXPECT_EQ(config.get("", "key1"), "");
+    EXPECT_EQ(config.get("section1", "key3"), "value3");
+    EXPECT_EQ(config.get("section2", "key4"), "value with    spaces");
+
+    EXPECT_FALSE(config.loadFromFile("nonexistent.ini", err, filter));
+
+    // a lambda converts without naming SectionFilter
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err, [](std::string_view s) { return s == "section2"; }));
+    EXPECT_EQ(config.get("section2", "user"), "admin");
+    EXPECT_EQ(config.get("section1", "host"), "");
+}
+
+// Test that a filtered load reports keys and malformed lines of the sections it loads
+TEST_F(ConfigTest, SectionFilterCountsMalformed) {
+    auto metrics = std::make_shared<ConfigMetrics>();
+    config.setMetrics(metrics);
+    ASSERT_TRUE(config.loadFromFile("test_malformed.ini", err, {"section1"}));
+    ConfigMetrics::Totals t = metrics->totals();
+    EXPECT_EQ(t.keys, 2u);
+    EXPECT_EQ(t.malformed, 2u); // the two in [section1]; skipped sections are not tokenized
+
+    ASSERT_TRUE(config.loadFromFile("test_malformed.ini", err, {"", "section1"}));
+    t = metrics->totals();
+    EXPECT_EQ(t.keys, 5u);
+    EXPECT_EQ(t.malformed, 6u);
+}
+
+// Test set and erase on a loaded config
+TEST_F(ConfigTest, SetAndErase) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err));
+    config.set("section1", "host", "example.org");
+    config.set("new", "key", "value");
+    EXPECT_EQ(config.get("section1", "host"), "example.org");
+    EXPECT_EQ(config.get("new", "key"), "value");
+
+    EXPECT_TRUE(config.erase("new", "key"));
+    EXPECT_FALSE(config.erase("new", "key"));
+    EXPECT_EQ(config.section("new"), nullptr);
+
+    // Writes to a lazily loaded config keep the unread sections
+    ASSERT_TRUE(config.loadLazy("test_valid.ini", err));
+    config.set("section1", "port", "9090");
+    EXPECT_EQ(config.get("section1", "port"), "9090");
+    EXPECT_EQ(config.get("section2", "user"), "admin");
+}
+
+// Test that copies share storage until one of them writes
+TEST_F(ConfigTest, CopyOnWriteClones) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err));
+    Config clone = config;
+    EXPECT_EQ(clone.section("section1"), config.section("section1"));
+
+    clone.set("section1", "host", "tenant.example.org");
+    EXPECT_EQ(clone.get("section1", "host"), "tenant.example.org");
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+
+    // Only the touched section was copied
+    EXPECT_NE(clone.section("section1"), config.section("section1"));
+    EXPECT_EQ(clone.section("section2"), config.section("section2"));
+
+    // Writing to the original after the clone diverged copies nothing shared
+    config.set("section2", "user", "root");
+    EXPECT_EQ(clone.get("section2", "user"), "admin");
+}
+
+// Test that saved files load back unchanged
+TEST_F(ConfigTest, SaveAndReload) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err));
+    config.set("section3", "url", "https://example.com:8080/path?query=value");
+
+    std::string text;
+    config.serialize(text);
+    EXPECT_EQ(text.size(), config.serializedSize());
+    EXPECT_EQ(text.compare(0, 3, "key"), 0); // top-level keys come first
+
+    ASSERT_TRUE(config.saveToFile("test_saved.ini", err)) << "Error: " << err;
+    Config reloaded;
+    ASSERT_TRUE(reloaded.loadFromFile("test_saved.ini", err));
+    for (const std::string &name : config.sections()) {
+        ASSERT_NE(reloaded.section(name), nullptr) << name;
+        EXPECT_EQ(*reloaded.section(name), *config.section(name)) << name;
+    }
+    EXPECT_EQ(reloaded.sections().size(), config.sections().size());
+
+    std::ifstream ifs("test_saved.ini", std::ios::binary);
+    std::string on_disk((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(on_disk, text);
+}
+
+// Test saving an empty config and an unwritable path
+TEST_F(ConfigTest, SaveEdgeCases) {
+    ASSERT_TRUE(config.saveToFile("test_saved_empty.ini", err));
+    ASSERT_TRUE(config.loadFromFile("test_saved_empty.ini", err));
+    EXPECT_TRUE(config.sections().empty());
+    EXPECT_FALSE(config.saveToFile("no_such_dir/test.ini", err));
+    EXPECT_FALSE(err.empty());
+}
+
+#if !defined(_WIN32)
+// Test loading from a pipe, which cannot be mapped
+TEST_F(ConfigTest, LoadFromFifo) {
+    std::remove("test_fifo.ini");
+    ASSERT_EQ(::mkfifo("test_fifo.ini", 0600), 0);
+    std::thread writer([] { std::ofstream("test_fifo.ini") << "[s]\nk=v\n"; });
+    EXPECT_TRUE(config.loadFromFile("test_fifo.ini", err)) << "Error: " << err;
+    writer.join();
+    EXPECT_EQ(config.get("s", "k"), "v");
+    std::remove("test_fifo.ini");
+}
+
+// Test that a small lazily loaded file is copied, so rewriting it in place is harmless
+TEST_F(ConfigTest, LazySmallFileIsCopied) {
+    std::ofstream("test_lazy_copy.ini") << "[a]\nx=1\n[b]\ny=2\n";
+    ASSERT_TRUE(config.loadLazy("test_lazy_copy.ini", err)) << "Error: " << err;
+    ASSERT_EQ(::truncate("test_lazy_copy.ini", 0), 0);
+    EXPECT_EQ(config.get("b", "y"), "2");
+}
+
+// Test that saving over an existing file keeps its permissions and leaves no temporary behind
+TEST_F(ConfigTest, SaveKeepsMode) {
+    config.set("db", "password", "secret");
+    ASSERT_TRUE(config.saveToFile("test_saved_mode.ini", err)) << err;
+    ASSERT_EQ(::chmod("test_saved_mode.ini", 0600), 0);
+    config.set("db", "user", "admin");
+    ASSERT_TRUE(config.saveToFile("test_saved_mode.ini", err)) << err;
+
+    struct stat st;
+    ASSERT_EQ(::stat("test_saved_mode.ini", &st), 0);
+    EXPECT_EQ(st.st_mode & 0777, 0600u);
+    Config reloaded;
+    ASSERT_TRUE(reloaded.loadFromFile("test_saved_mode.ini", err));
+    EXPECT_EQ(reloaded.get("db", "user"), "admin");
+    for (const auto &entry : std::filesystem::directory_iterator("."))
+        EXPECT_EQ(entry.path().filename().string().rfind("test_saved_mode.ini.tmp", 0), std::string::npos);
+}
+#endif
+
+// Test which entries survive a round trip
+TEST(ConfigSerializeTest, CanSerialize) {
+    EXPECT_TRUE(Config::canSerialize("s", "key", "value with spaces"));
+    EXPECT_TRUE(Config::canSerialize("", "url", "a=b"));
+    EXPECT_FALSE(Config::canSerialize("s", "key", "a;b"));
+    EXPECT_FALSE(Config::canSerialize("s", "key", " padded"));
+    EXPECT_FALSE(Config::canSerialize("s", "a=b", "v"));
+    EXPECT_FALSE(Config::canSerialize("s", "[key", "v]"));
+    EXPECT_FALSE(Config::canSerialize("multi\nline", "key", "v"));
+}
+
+// Test that repeated lookups hit the per-thread cache
+TEST_F(ConfigTest, LookupCacheHits) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    config.enableLookupCache();
+    Config::resetLookupCacheStats();
+
+    // Slots are keyed on the caller's buffers, so reuse the same strings
+    const std::string section = "section1", host = "host", nokey = "nokey";
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(config.get(section, host), "localhost");
+        EXPECT_EQ(config.get(section, nokey, "default"), "default");
+    }
+    Config::LookupCacheStats stats = Config::lookupCacheStats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.hits, 18u);
+}
+
+// Test that changes to a cached config are never served from stale entries
+TEST_F(ConfigTest, LookupCacheInvalidation) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    config.enableLookupCache();
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+    EXPECT_EQ(config.get("section1", "new", "none"), "none");
+
+    config.set("section1", "host", "example.org");
+    config.set("section1", "new", "yes");
+    EXPECT_EQ(config.get("section1", "host"), "example.org");
+    EXPECT_EQ(config.get("section1", "new", "none"), "yes");
+
+    config.erase("section1", "new");
+    EXPECT_EQ(config.get("section1", "new", "none"), "none");
+
+    // A buffer rewritten in place must not hit the entry of its old contents
+    std::string key = "host";
+    EXPECT_EQ(config.get("section1", key), "example.org");
+    key.replace(0, 4, "port");
+    EXPECT_EQ(config.get("section1", key), "8080");
+
+    Config other;
+    other.set("section1", "host", "other.org");
+    config = other;
+    EXPECT_EQ(config.get("section1", "host"), "other.org");
+
+    Config moved = std::move(config);
+    EXPECT_EQ(config.get("section1", "host", "empty"), "empty");
+    EXPECT_EQ(moved.get("section1", "host"), "other.org");
+
+    ASSERT_TRUE(moved.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    EXPECT_EQ(moved.get("section1", "host"), "localhost");
+}
+
+// Test the reader's line and byte counters
+TEST(IniReaderTest, LinesAndBytes) {
+    const std::string text = "a=1\n\n; c\n[s]\nb=2";
+    IniReader reader(text);
+    IniEvent ev;
+    ASSERT_TRUE(reader.next(ev));
+    EXPECT_EQ(reader.lines(), 1u);
+    EXPECT_EQ(reader.bytes(), 4u);
+    while (reader.next(ev)) {
+    }
+    EXPECT_EQ(reader.lines(), 5u);
+    EXPECT_EQ(reader.bytes(), text.size());
+}
+
+// Test that find() returns pointers into the config without copying
+TEST_F(ConfigTest, FindWithoutCopy) {
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    const std::string *host = config.find("section1", "host");
+    ASSERT_NE(host, nullptr);
+    EXPECT_EQ(*host, "localhost");
+    EXPECT_EQ(config.find("section1", "host"), host);
+    EXPECT_EQ(config.find("section1", "nokey"), nullptr);
+    EXPECT_EQ(config.find("nosection", "host"), nullptr);
+
+    config.enableLookupCache();
+    EXPECT_EQ(config.find("section1", "host"), host);
+    EXPECT_EQ(config.find("section1", "nokey"), nullptr);
+}
+
+// Test that the bounded streaming load matches loadFromFile, even with a tiny buffer
+TEST_F(ConfigTest, ParseLimitsMatchesFullLoad) {
+    for (const char *path : {"test_valid.ini", "test_comments.ini", "test_whitespace.ini", "test_malformed.ini"}) {
+        Config full, bounded;
+        ASSERT_TRUE(full.loadFromFile(path, err)) << "Error: " << err;
+        ParseLimits limits;
+        limits.buffer_size = 7;
+        ASSERT_TRUE(bounded.loadFromFile(path, err, limits)) << "Error: " << err;
+        auto names = full.sections();
+        EXPECT_EQ(bounded.sections().size(), names.size()) << path;
+        for (const auto &name : names) {
+            ASSERT_NE(bounded.section(name), nullptr) << path << " [" << name << "]";
+            EXPECT_EQ(*bounded.section(name), *full.section(name)) << path << " [" << name << "]";
+        }
+    }
+    EXPECT_FALSE(config.loadFromFile("nonexistent.ini", err, ParseLimits()));
+    EXPECT_EQ(err, "Could not open config file: nonexistent.ini");
+}
+
+// Test that overlong lines and oversized input fail with a clear error
+TEST_F(ConfigTest, ParseLimitsExceeded) {
+    std::ofstream("test_limits.ini") << "[s]\nshort=1\nlong=" << std::string(100, 'x') << "\nafter=2\n";
+    ParseLimits limits;
+    limits.max_line_length = 64;
+    limits.buffer_size = 16;
+    EXPECT_FALSE(config.loadFromFile("test_limits.ini", err, limits));
+    EXPECT_EQ(err, "Config line 3 is longer than 64 bytes: test_limits.ini");
+    EXPECT_EQ(config.get("s", "short", "cleared"), "cleared");
+
+    limits.max_line_length = 200;
+    ASSERT_TRUE(config.loadFromFile("test_limits.ini", err, limits)) << "Error: " << err;
+    EXPECT_EQ(config.get("s", "after"), "2");
+
+    limits.max_total_bytes = 50;
+    EXPECT_FALSE(config.loadFromFile("test_limits.ini", err, limits));
+    EXPECT_EQ(err, "Config file is larger than 50 bytes: test_limits.ini");
+
+    // Streams are counted as they arrive
+    std::string text(1000, '\n');
+    size_t pos = 0;
+    EXPECT_FALSE(config.loadFromStream(
+        [&](char *buf, size_t size, size_t &got, std::string &) {
+            got = text.copy(buf, size, pos);
+            pos += got;
+            return true;
+        },
+        err, limits));
+    EXPECT_EQ(err, "Config input is larger than 50 bytes");
+    EXPECT_LE(pos, 50u + limits.buffer_size);
+}
+
+// Test the push parser's line length limit
+TEST(IniPushParserTest, MaxLineLength) {
+    IniPushParser parser(8);
+    parser.feed("a=1\nb=12");
+    parser.feed("345");
+    EXPECT_EQ(parser.overlongLine(), 0u);
+    parser.feed("67\nc=3\n");
+    EXPECT_EQ(parser.overlongLine(), 2u);
+    Config config = parser.finish();
+    EXPECT_EQ(config.get("", "a"), "1");
+    EXPECT_EQ(config.get("", "c", "none"), "none");
+    EXPECT_EQ(parser.overlongLine(), 0u);
+}
+
+// Test that strict mode loads clean files like loadFromFile
+TEST_F(ConfigTest, StrictCleanFile) {
+    IniDiagnostics diags;
+    ASSERT_TRUE(config.loadStrict("test_valid.ini", err, 1, &diags)) << "Error: " << err;
+    EXPECT_TRUE(diags.empty());
+    EXPECT_EQ(config.get("section1", "host"), "localhost");
+    EXPECT_EQ(config.get("section2", "password"), "secret123");
+
+    EXPECT_FALSE(config.loadStrict("nonexistent.ini", err));
+    EXPECT_EQ(err, "Could not open config file: nonexistent.ini");
+}
+
+// Test that strict mode fails at the first problem with its line and column
+TEST_F(ConfigTest, StrictFailFast) {
+    EXPECT_FALSE(config.loadStrict("test_malformed.ini", err));
+    EXPECT_EQ(err, "test_malformed.ini:4:1: expected a section header, key=value entry or comment");
+    EXPECT_EQ(config.get("", "valid_key", "cleared"), "cleared");
+}
+
+// Test collecting several diagnostics of every kind
+TEST_F(ConfigTest, StrictCollectsDiagnostics) {
+    std::ofstream("test_strict.ini") << "a=1\n"
+                                        "  = 2\n"
+                                        "[]\n"
+                                        "[open\n"
+                                        "[s]\n"
+                                        "k=1\n"
+                                        "  k = 2\n"
+                                        "[open=3\n"
+                                        "no equals\n";
+    IniDiagnostics diags;
+    EXPECT_FALSE(config.loadStrict("test_strict.ini", err, 0, &diags));
+    EXPECT_EQ(err, "test_strict.ini:2:3: empty key (and 5 more)");
+    ASSERT_EQ(diags.size(), 6u);
+    EXPECT_FALSE(diags.stoppedEarly());
+    const IniDiagnostic::Code codes[] = {IniDiagnostic::Code::EmptyKey, IniDiagnostic::Code::EmptySectionName,
+                                         IniDiagnostic::Code::UnterminatedSection, IniDiagnostic::Code::DuplicateKey,
+                                         IniDiagnostic::Code::UnterminatedSection, IniDiagnostic::Code::MissingEquals};
+    const size_t lines[] = {2, 3, 4, 7, 8, 9};
+    const size_t columns[] = {3, 2, 1, 3, 1, 1};
+    std::vector<IniDiagnostics::Position> pos = diags.positions();
+    for (size_t i = 0; i < diags.size(); ++i) {
+        EXPECT_EQ(diags[i].code, codes[i]) << i;
+        EXPECT_EQ(pos[i].line, lines[i]) << i;
+        EXPECT_EQ(pos[i].column, columns[i]) << i;
+        EXPECT_EQ(diags.position(i).line, lines[i]) << i;
+        EXPECT_EQ(diags.position(i).column, columns[i]) << i;
+    }
+    EXPECT_EQ(diags.format(3), "test_strict.ini:7:3: duplicate key in section");
+
+    EXPECT_FALSE(config.loadStrict("test_strict.ini", err, 2, &diags));
+    EXPECT_EQ(diags.size(), 2u);
+    EXPECT_TRUE(diags.stoppedEarly());
+    EXPECT_EQ(diags.toString(), "test_strict.ini:2:3: empty key\n"
+                                "test_strict.ini:3:2: empty section name\n"
+                                "test_strict.ini: stopped after 2 errors\n");
+
+    // positions were resolved during the load, so rewriting the file does not affect them
+    std::ofstream("test_strict.ini", std::ios::trunc) << "";
+    EXPECT_EQ(diags.format(1), "test_strict.ini:3:2: empty section name");
+}
+
+// Test that a section split into several blocks merges, with duplicates checked per block
+TEST_F(ConfigTest, StrictRepeatedSection) {
+    std::ofstream("test_strict_blocks.ini") << "[s]\n"
+                                               "k=1\n"
+                                               "[t]\n"
+                                               "x=1\n"
+                                               "[s]\n"
+                                               "k=2\n"
+                                               "j=3\n";
+    ASSERT_TRUE(config.loadStrict("test_strict_blocks.ini", err)) << "Error: " << err;
+    EXPECT_EQ(config.get("s", "k"), "2"); // later blocks win, as in loadFromFile
+    EXPECT_EQ(config.get("s", "j"), "3");
+
+    std::ofstream("test_strict_blocks.ini", std::ios::app) << "k=4\n";
+    EXPECT_FALSE(config.loadStrict("test_strict_blocks.ini", err));
+    EXPECT_EQ(err, "test_strict_blocks.ini:8:1: duplicate key in section");
+}
@@ -0,0 +1,169 @@
+#include <iniparsercxx_journal.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+// Copy a test file so the journal tests can modify it
+static std::string freshCopy(const std::string &from, const std::string &to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+    std::remove((to + ".journal").c_str());
+    return to;
+}
+
+// Test that overrides survive reopening
+TEST(JournaledConfigTest, ReplayOnOpen) {
+    std::string path = freshCopy("test_valid.ini", "test_journal_replay.ini");
+    std::string err;
+    {
+        JournaledConfig config(0);
+        ASSERT_TRUE(config.open(path, err)) << "Error: " << err;
+        EXPECT_EQ(config.get("section1", "host"), "localhost");
+        ASSERT_TRUE(config.set("section1", "host", "example.org", err));
+        ASSERT_TRUE(config.erase("section2", "password", err));
+        ASSERT_TRUE(config.set("new", "note", "a;b#c", err));
+        EXPECT_EQ(config.get("section1", "host"), "example.org");
+    }
+
+    // The INI file itself was not rewritten
+    Config plain;
+    ASSERT_TRUE(plain.loadFromFile(path, err));
+    EXPECT_EQ(plain.get("section1", "host"), "localhost");
+
+    JournaledConfig reopened(0);
+    ASSERT_TRUE(reopened.open(path, err)) << "Error: " << err;
+    EXPECT_EQ(reopened.get("section1", "host"), "example.org");
+    EXPECT_EQ(reopened.get("section2", "password", "gone"), "gone");
+    EXPECT_EQ(reopened.get("new", "note"), "a;b#c");
+}
+
+// Test that a torn record at the end of the journal is dropped
+TEST(JournaledConfigTest, TornRecord) {
+    std::string path = freshCopy("test_valid.ini", "test_journal_torn.ini");
+    std::string err;
+    size_t good;
+    {
+        JournaledConfig config(0);
+        ASSERT_TRUE(config.open(path, err));
+        ASSERT_TRUE(config.set("section1", "port", "9090", err));
+        good = config.journalSize();
+    }
+    std::ofstream(path + ".journal", std::ios::binary | std::ios::app) << "S\x05\x00";
+
+    JournaledConfig config(0);
+    ASSERT_TRUE(config.open(path, err)) << "Error: " << err;
+    EXPECT_EQ(config.get("section1", "port"), "9090");
+    EXPECT_EQ(config.journalSize(), good);
+    ASSERT_TRUE(config.set("section1", "port", "9191", err));
+
+    JournaledConfig again(0);
+    ASSERT_TRUE(again.open(path, err));
+    EXPECT_EQ(again.get("section1", "port"), "9191");
+}
+
+// Test folding the journal into the INI file
+TEST(JournaledConfigTest, Compaction) {
+    std::string path = freshCopy("test_valid.ini", "test_journal_compact.ini");
+    std::string err;
+    JournaledConfig config(0);
+    ASSERT_TRUE(config.open(path, err));
+    ASSERT_TRUE(config.set("section1", "host", "example.org", err));
+    ASSERT_TRUE(config.set("new", "note", "a;b", err));
+    size_t before = config.journalSize();
+
+    ASSERT_TRUE(config.compact(err)) << "Error: " << err;
+    EXPECT_LT(config.journalSize(), before);
+
+    // The INI file now holds the override; the unrepresentable value stays journaled
+    Config plain;
+    ASSERT_TRUE(plain.loadFromFile(path, err));
+    EXPECT_EQ(plain.get("section1", "host"), "example.org");
+    EXPECT_EQ(plain.get("", "key2"), "value with spaces");
+    EXPECT_EQ(plain.get("new", "note", "absent"), "absent");
+
+    JournaledConfig reopened(0);
+    ASSERT_TRUE(reopened.open(path, err));
+    EXPECT_EQ(reopened.get("section1", "host"), "example.org");
+    EXPECT_EQ(reopened.get("new", "note"), "a;b");
+}
+
+// Test that crossing the threshold triggers background compaction
+TEST(JournaledConfigTest, BackgroundCompaction) {
+    std::string path = freshCopy("test_valid.ini", "test_journal_background.ini");
+    std::string err;
+    JournaledConfig config(256);
+    ASSERT_TRUE(config.open(path, err));
+    for (int i = 0; i < 50; ++i) ASSERT_TRUE(config.set("section1", "counter", std::to_string(i), err));
+
+    for (int i = 0; i < 200 && config.journalSize() > 256; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_LE(config.journalSize(), 256u);
+    EXPECT_EQ(config.lastCompactError(), "");
+    EXPECT_EQ(config.get("section1", "counter"), "49");
+
+    std::string value;
+    for (int i = 0; i < 200; ++i) {
+        if (Config::peek(path, "section1", "counter", value, err) && value == "49") break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(value, "49");
+}
+
+// Test that compaction edits the INI file in place, keeping comments and layout
+TEST(JournaledConfigTest, CompactionKeepsComments) {
+    std::string path = freshCopy("test_valid.ini", "test_journal_comments.ini");
+    std::string err;
+    JournaledConfig config(0);
+    ASSERT_TRUE(config.open(path, err));
+    ASSERT_TRUE(config.set("section1", "port", "9090", err));
+    ASSERT_TRUE(config.erase("section2", "password", err));
+    ASSERT_TRUE(config.compact(err)) << "Error: " << err;
+
+    std::ifstream in(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(text,
+              "; Valid INI file with sections\n"
+              "key1=value1\n"
+              "key2=value with spaces\n"
+              "\n"
+              "[section1]\n"
+              "host=localhost\n"
+              "port=9090\n"
+              "enabled=true\n"
+              "\n"
+              "[section2]\n"
+              "name=test database\n"
+              "user=admin\n");
+}
+
+// Test that the threshold counts only records appended since the last compaction,
+// so entries that have to stay journaled do not trigger compaction again
+TEST(JournaledConfigTest, ThresholdIgnoresKeptEntries) {
+    std::string path = freshCopy("test_valid.ini", "test_journal_kept.ini");
+    std::string err;
+    JournaledConfig config(64);
+    ASSERT_TRUE(config.open(path, err));
+    std::string note = std::string(100, 'x') + ";unserializable";
+    ASSERT_TRUE(config.set("section1", "note", note, err));
+    ASSERT_TRUE(config.set("section1", "port", "9090", err));
+
+    // once compacted, the journal holds the magic and the note only
+    size_t kept = 8 + 13 + 8 + 4 + note.size();
+    for (int i = 0; i < 200 && config.journalSize() != kept; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(config.journalSize(), kept);
+    EXPECT_EQ(config.lastCompactError(), "");
+
+    // a small change stays below the threshold and is not folded into the file
+    ASSERT_TRUE(config.set("section1", "port", "9", err));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_GT(config.journalSize(), kept);
+    std::string value;
+    ASSERT_TRUE(Config::peek(path, "section1", "port", value, err));
+    EXPECT_EQ(value, "9090");
+}
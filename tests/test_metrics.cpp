@@ -0,0 +1,96 @@
+#include <iniparsercxx_metrics.hpp>
+#include <iniparsercxx.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test counts for loads and lookups
+TEST(ConfigMetricsTest, CountsLoadsAndGets) {
+    auto metrics = std::make_shared<ConfigMetrics>();
+    Config config;
+    config.setMetrics(metrics);
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_malformed.ini", err)) << "Error: " << err;
+    EXPECT_FALSE(config.loadFromFile("nonexistent.ini", err));
+
+    ConfigMetrics::Totals t = metrics->totals();
+    EXPECT_EQ(t.loads, 2u);
+    EXPECT_EQ(t.load_failures, 1u);
+    EXPECT_GT(t.bytes, 0u);
+    EXPECT_GT(t.keys, 0u);
+    EXPECT_GT(t.malformed, 0u);
+
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    config.get("section1", "host");
+    config.get("section1", "nokey");
+    t = metrics->totals();
+    EXPECT_EQ(t.gets, 2u);
+    EXPECT_EQ(t.misses, 1u);
+}
+
+// Test that an unchanged file is not parsed again
+TEST(ConfigMetricsTest, ReloadIfChanged) {
+    std::ofstream("test_metrics_reload.ini") << "[a]\nx=1\n";
+    auto metrics = std::make_shared<ConfigMetrics>();
+    Config config;
+    config.setMetrics(metrics);
+    std::string err;
+    bool reloaded = false;
+    ASSERT_TRUE(config.reloadIfChanged("test_metrics_reload.ini", reloaded, err)) << "Error: " << err;
+    EXPECT_TRUE(reloaded);
+    ASSERT_TRUE(config.reloadIfChanged("test_metrics_reload.ini", reloaded, err)) << "Error: " << err;
+    EXPECT_FALSE(reloaded);
+    EXPECT_EQ(metrics->totals().reloads_skipped, 1u);
+
+    // an edit in memory means the config no longer matches the file
+    config.set("a", "x", "2");
+    ASSERT_TRUE(config.reloadIfChanged("test_metrics_reload.ini", reloaded, err)) << "Error: " << err;
+    EXPECT_TRUE(reloaded);
+    EXPECT_EQ(config.get("a", "x"), "1");
+
+    std::ofstream("test_metrics_reload.ini") << "[a]\nx=22\n";
+    ASSERT_TRUE(config.reloadIfChanged("test_metrics_reload.ini", reloaded, err)) << "Error: " << err;
+    EXPECT_TRUE(reloaded);
+    EXPECT_EQ(config.get("a", "x"), "22");
+    EXPECT_EQ(metrics->totals().loads, 3u);
+}
+
+// Test the exposition text and rendering into a small buffer
+TEST(ConfigMetricsTest, Render) {
+    ConfigMetrics metrics("config=\"svc\"");
+    metrics.recordLoad(true, 5000000, 100, 10, 1); // 5 ms
+    for (int t = 0; t < 4; ++t) metrics.recordGet(t != 0);
+
+    char buf[8192];
+    size_t n = metrics.render(buf, sizeof(buf));
+    ASSERT_LT(n, sizeof(buf));
+    std::string text(buf, n);
+    EXPECT_NE(text.find("# TYPE iniparsercxx_gets_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("iniparsercxx_gets_total{config=\"svc\"} 4\n"), std::string::npos);
+    EXPECT_NE(text.find("iniparsercxx_get_misses_total{config=\"svc\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("iniparsercxx_load_duration_seconds_bucket{config=\"svc\",le=\"0.001\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("iniparsercxx_load_duration_seconds_bucket{config=\"svc\",le=\"0.01\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("iniparsercxx_load_duration_seconds_count{config=\"svc\"} 1\n"), std::string::npos);
+
+    char small[16];
+    EXPECT_EQ(metrics.render(small, sizeof(small)), n);
+    EXPECT_EQ(std::string(small), text.substr(0, sizeof(small) - 1));
+}
+
+// Test that counts from many threads add up
+TEST(ConfigMetricsTest, Threads) {
+    ConfigMetrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) metrics.recordGet(i % 10 != 0);
+        });
+    }
+    for (auto &t : threads) t.join();
+    EXPECT_EQ(metrics.totals().gets, 80000u);
+    EXPECT_EQ(metrics.totals().misses, 8000u);
+}
@@ -0,0 +1,129 @@
+#include <iniparsercxx_numa.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test lookups through the local replica
+TEST(NumaConfigTest, PublishAndGet) {
+    NumaConfig numa;
+    EXPECT_EQ(numa.replicas(), 0u);
+    EXPECT_EQ(numa.get("section1", "host", "default"), "default");
+
+    Config config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    ASSERT_TRUE(numa.publish(config, err)) << "Error: " << err;
+    EXPECT_GE(numa.replicas(), 1u);
+    EXPECT_EQ(numa.generation(), 1u);
+    EXPECT_EQ(numa.get("section1", "host"), "localhost");
+    EXPECT_EQ(numa.get("", "key1"), "value1");
+    EXPECT_EQ(numa.get("section1", "nokey", "default"), "default");
+
+    config.set("section1", "host", "example.org");
+    ASSERT_TRUE(numa.publish(config, err)) << "Error: " << err;
+    EXPECT_EQ(numa.get("section1", "host"), "example.org");
+}
+
+// Test that the per-thread cache tells instances apart
+TEST(NumaConfigTest, SeparateInstances) {
+    NumaConfig a, b;
+    Config config;
+    std::string err;
+    config.set("s", "k", "a");
+    ASSERT_TRUE(a.publish(config, err));
+    config.set("s", "k", "b");
+    ASSERT_TRUE(b.publish(config, err));
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(a.get("s", "k"), "a");
+        EXPECT_EQ(b.get("s", "k"), "b");
+    }
+}
+
+// Test that readers never see a mix of two versions while publishes run
+TEST(NumaConfigTest, ConsistentAcrossReloads) {
+    NumaConfig numa;
+    std::string err;
+    Config config;
+    config.set("s", "a", "0");
+    config.set("s", "b", "0");
+    ASSERT_TRUE(numa.publish(config, err));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            long last = 0;
+            while (!done.load()) {
+                long v = std::stol(numa.get("s", "a", "-1"));
+                if (v < last) ++failures; // versions only move forward
+                last = v;
+            }
+        });
+    }
+    for (int i = 1; i <= 200; ++i) {
+        config.set("s", "a", std::to_string(i));
+        ASSERT_TRUE(numa.publish(config, err));
+    }
+    done = true;
+    for (auto &t : readers) t.join();
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(numa.get("s", "a"), "200");
+}
+
+// Test more instances than thread slots, and values kept until the thread reads again
+TEST(NumaConfigTest, ManyInstances) {
+    const size_t n = NumaConfig::kThreadSlots * 2 + 1;
+    std::vector<std::unique_ptr<NumaConfig>> instances;
+    Config config;
+    std::string err;
+    for (size_t i = 0; i < n; ++i) {
+        instances.push_back(std::make_unique<NumaConfig>());
+        config.set("s", "k", "v" + std::to_string(i));
+        ASSERT_TRUE(instances.back()->publish(config, err));
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < n; ++i) EXPECT_EQ(instances[i]->get("s", "k"), "v" + std::to_string(i));
+    }
+
+    std::string_view value;
+    ASSERT_TRUE(instances[0]->find("s", "k", value));
+    config.set("s", "k", "new");
+    ASSERT_TRUE(instances[0]->publish(config, err));
+    EXPECT_EQ(value, "v0"); // the old replica is retired, not freed
+    EXPECT_EQ(instances[0]->get("s", "k"), "new");
+
+    // slots of destroyed instances are reused
+    instances.erase(instances.begin(), instances.begin() + 4);
+    for (size_t i = 4; i < n; ++i) EXPECT_EQ(instances[i - 4]->get("s", "k"), "v" + std::to_string(i));
+}
+
+// Test that instances and reader threads may end in either order
+TEST(NumaConfigTest, ThreadAndInstanceLifetimes) {
+    Config config;
+    std::string err;
+    config.set("s", "k", "v");
+
+    auto early = std::make_unique<NumaConfig>();
+    NumaConfig late;
+    ASSERT_TRUE(early->publish(config, err));
+    ASSERT_TRUE(late.publish(config, err));
+
+    std::atomic<int> stage{0};
+    std::thread reader([&] {
+        EXPECT_EQ(early->get("s", "k"), "v");
+        EXPECT_EQ(late.get("s", "k"), "v");
+        stage = 1;
+        while (stage.load() != 2) std::this_thread::yield();
+    });
+    while (stage.load() != 1) std::this_thread::yield();
+    early.reset(); // destroyed while the reader thread still caches it
+    config.set("s", "k", "w");
+    ASSERT_TRUE(late.publish(config, err)); // the reader's old replica stays retired
+    stage = 2;
+    reader.join(); // thread exit unregisters and frees it
+    EXPECT_EQ(late.get("s", "k"), "w");
+}
@@ -0,0 +1,97 @@
+#include <iniparsercxx_profile.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test hot keys, misses and unread keys
+TEST(LookupProfilerTest, Report) {
+    Config config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    auto profiler = std::make_shared<LookupProfiler>();
+    config.setProfiler(profiler);
+
+    for (int i = 0; i < 5; ++i) config.get("section1", "host");
+    for (int i = 0; i < 2; ++i) config.get("section1", "port");
+    for (int i = 0; i < 3; ++i) config.get("section1", "timeout", "30");
+
+    LookupProfiler::Report report = profiler->report(config, 1);
+    EXPECT_EQ(report.lookups, 10u);
+    ASSERT_EQ(report.hot.size(), 1u);
+    EXPECT_EQ(report.hot[0].section, "section1");
+    EXPECT_EQ(report.hot[0].key, "host");
+    EXPECT_EQ(report.hot[0].count, 5u);
+    ASSERT_EQ(report.misses.size(), 1u);
+    EXPECT_EQ(report.misses[0].key, "timeout");
+    EXPECT_EQ(report.misses[0].count, 3u);
+
+    // 8 entries in the file, host and port were read
+    EXPECT_EQ(report.unread.size(), 6u);
+    for (const auto &k : report.unread) EXPECT_TRUE(k.second != "host" && k.second != "port");
+
+    ASSERT_FALSE(report.call_sites.empty());
+    EXPECT_NE(report.toString().find("[section1] host"), std::string::npos);
+
+    profiler->reset();
+    EXPECT_EQ(profiler->report(config).lookups, 0u);
+}
+
+// Test that counts from several threads are merged and scaled by the sample rate
+TEST(LookupProfilerTest, ThreadsAndSampling) {
+    Config config;
+    config.set("s", "k", "v");
+    auto profiler = std::make_shared<LookupProfiler>(4);
+    config.setProfiler(profiler);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) config.get("s", "k");
+        });
+    }
+    for (auto &t : threads) t.join();
+
+    LookupProfiler::Report report = profiler->report(config);
+    EXPECT_EQ(report.lookups, 4000u);
+    ASSERT_EQ(report.hot.size(), 1u);
+    EXPECT_EQ(report.hot[0].count, 4000u);
+    EXPECT_TRUE(report.unread.empty());
+
+    config.setProfiler(nullptr);
+    config.get("s", "k");
+    EXPECT_EQ(profiler->report(config).lookups, 4000u);
+}
+
+// Test reports taken while threads are sampling, and samples beyond the shard capacity
+TEST(LookupProfilerTest, ConcurrentReportAndCapacity) {
+    Config config;
+    config.set("s", "k", "v");
+    auto profiler = std::make_shared<LookupProfiler>();
+    config.setProfiler(profiler);
+
+    std::atomic<bool> stop{false};
+    std::thread reader([&] {
+        while (!stop.load()) config.get("s", "k");
+    });
+    uint64_t last = 0;
+    for (int i = 0; i < 50; ++i) {
+        uint64_t n = profiler->report(config).lookups;
+        EXPECT_GE(n, last);
+        last = n;
+    }
+    stop = true;
+    reader.join();
+
+    // 5000 distinct keys on one thread: the shard holds 4096
+    profiler->reset();
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; ++i) keys.push_back("k" + std::to_string(i));
+    for (const auto &k : keys) config.get("s", k);
+    LookupProfiler::Report report = profiler->report(config, 10000);
+    EXPECT_EQ(report.misses.size() + report.hot.size(), 4096u);
+    EXPECT_EQ(report.dropped, 5000u - 4096u);
+    EXPECT_EQ(report.lookups + report.dropped, 5000u);
+}
@@ -0,0 +1,148 @@
+// Read scalability of a shared const Config.
+//
+// Runs get() and find() from 1, 2, 4, ... threads (up to the hardware
+// concurrency, capped at 64, or INIPARSERCXX_SCALING_THREADS) and prints the
+// per-thread throughput and the efficiency relative to one thread. Values are
+// longer than the small-string buffer, so every get() allocates; when get()
+// scales much worse than find() the readers contend in the allocator.
+//
+// Timings on shared machines are noisy, so the only throughput assertion is a
+// generous one: with n readers on n free cores, find() must reach at least a
+// quarter of n times the one-thread throughput. Readers that serialize on a
+// lock or a shared cache line stay near 1x and fail it on multi-core machines.
+
+#include <iniparsercxx.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kSections = 32;
+const int kKeys = 32;
+
+std::string valueFor(int s, int k) {
+    return "a value longer than the small string buffer " + std::to_string(s) + "/" + std::to_string(k);
+}
+
+// Cores readers can actually run on in parallel.
+int cores() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+int maxThreads() {
+    if (const char *env = std::getenv("INIPARSERCXX_SCALING_THREADS")) {
+        int n = std::atoi(env);
+        if (n > 0) return n;
+    }
+    return std::min(64, cores());
+}
+
+// Per-thread counters on their own cache lines, so counting does not itself
+// become the shared write it is meant to measure.
+struct alignas(64) Counter {
+    uint64_t ops = 0;
+    bool ok = true;
+};
+
+// Run op from n threads for duration and return the total operations per second.
+template <typename Op>
+double run(int n, std::chrono::milliseconds duration, Op op, bool &ok) {
+    std::vector<Counter> counters(static_cast<size_t>(n));
+    std::atomic<int> ready{0};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n; ++t) {
+        threads.emplace_back([&, t] {
+            Counter &c = counters[static_cast<size_t>(t)];
+            unsigned i = static_cast<unsigned>(t) * 7919u;
+            ready.fetch_add(1);
+            while (ready.load() < n) std::this_thread::yield();
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int j = 0; j < 64; ++j, ++i) {
+                    int s = static_cast<int>(i % kSections), k = static_cast<int>((i / kSections) % kKeys);
+                    c.ok &= op(s, k);
+                }
+                c.ops += 64;
+            }
+        });
+    }
+    while (ready.load() < n) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto &th : threads) th.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (const Counter &c : counters) {
+        total += c.ops;
+        ok &= c.ok && c.ops > 0;
+    }
+    return static_cast<double>(total) / secs;
+}
+
+} // namespace
+
+TEST(ScalingTest, SharedConstReads) {
+    Config config;
+    std::vector<std::string> sections, keys;
+    for (int s = 0; s < kSections; ++s) sections.push_back("s" + std::to_string(s));
+    for (int k = 0; k < kKeys; ++k) keys.push_back("k" + std::to_string(k));
+    for (int s = 0; s < kSections; ++s)
+        for (int k = 0; k < kKeys; ++k) config.set(sections[s], keys[k], valueFor(s, k));
+    const Config &shared = config;
+
+    // Expected lengths only, so checking a result does not allocate either.
+    std::vector<size_t> lengths;
+    for (int s = 0; s < kSections; ++s)
+        for (int k = 0; k < kKeys; ++k) lengths.push_back(valueFor(s, k).size());
+    auto expected = [&](int s, int k) { return lengths[static_cast<size_t>(s * kKeys + k)]; };
+
+    auto get = [&](int s, int k) { return shared.get(sections[s], keys[k]).size() == expected(s, k); };
+    auto find = [&](int s, int k) {
+        const std::string *v = shared.find(sections[s], keys[k]);
+        return v && v->size() == expected(s, k);
+    };
+
+    const int max_threads = maxThreads();
+    const auto duration = std::chrono::milliseconds(50);
+    double get_base = 0, find_base = 0, get_eff = 1, find_eff = 1;
+    std::printf("%8s %16s %8s %16s %8s\n", "threads", "get/s/thread", "eff", "find/s/thread", "eff");
+    for (int n = 1;; n = std::min(n * 2, max_threads)) {
+        bool ok = true;
+        double get_rate = run(n, duration, get, ok) / n;
+        double find_rate = run(n, duration, find, ok) / n;
+        EXPECT_TRUE(ok) << "wrong value or idle thread with " << n << " threads";
+        if (n == 1) {
+            get_base = get_rate;
+            find_base = find_rate;
+        }
+        get_eff = get_rate / get_base;
+        find_eff = find_rate / find_base;
+        std::printf("%8d %16.0f %7.0f%% %16.0f %7.0f%%\n", n, get_rate, get_eff * 100, find_rate, find_eff * 100);
+        if (n == max_threads) break;
+    }
+    if (max_threads > 1 && get_eff < 0.5 * find_eff)
+        std::printf("get() scales much worse than find(): readers are likely contending in the allocator\n");
+
+    // Total find() throughput with max_threads readers against one reader.
+    // Measured once more over a longer run before failing, to ride out noise.
+    const double k = 0.25;
+    const double bound = k * std::min(max_threads, cores());
+    double speedup = find_eff * max_threads;
+    if (speedup < bound) {
+        bool ok = true;
+        const auto longer = std::chrono::milliseconds(200);
+        double base = run(1, longer, find, ok);
+        speedup = std::max(speedup, run(max_threads, longer, find, ok) / base);
+    }
+    EXPECT_GE(speedup, bound) << "find() from " << max_threads << " threads reached " << speedup
+                              << "x the one-thread throughput";
+}
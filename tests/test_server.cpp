@@ -0,0 +1,128 @@
+#include <iniparsercxx_server.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Server running on a background thread for the duration of a test
+class ServerFixture : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = "test_server_" + std::to_string(::getpid()) + ".sock";
+        Config config;
+        std::string err;
+        ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+        ASSERT_TRUE(server_.publish(config, err)) << "Error: " << err;
+        ASSERT_TRUE(server_.listen(path_, err)) << "Error: " << err;
+        thread_ = std::thread([this] {
+            std::string run_err;
+            server_.run(run_err);
+        });
+    }
+
+    void TearDown() override {
+        server_.stop();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    ConfigServer server_;
+    std::thread thread_;
+    std::string path_;
+};
+
+// Test a batched lookup with present and absent keys
+TEST_F(ServerFixture, BatchedGet) {
+    ConfigClient client;
+    std::string err;
+    ASSERT_TRUE(client.connect(path_, err)) << "Error: " << err;
+
+    ConfigClient::Values values;
+    ASSERT_TRUE(client.get({{"section1", "host"}, {"section1", "nokey"}, {"section2", "user"}}, values, err))
+        << "Error: " << err;
+    ASSERT_EQ(values.size(), 3u);
+    ASSERT_TRUE(values[0]);
+    EXPECT_EQ(*values[0], "localhost");
+    EXPECT_FALSE(values[1]);
+    ASSERT_TRUE(values[2]);
+    EXPECT_EQ(*values[2], "admin");
+    EXPECT_EQ(client.generation(), 1u);
+
+    EXPECT_EQ(client.get("section1", "port"), "8080");
+    EXPECT_EQ(client.get("nosection", "port", "default"), "default");
+}
+
+// Test that the socket file is private by default and takes the requested mode
+TEST(ServerTest, SocketMode) {
+    std::string path = "test_server_mode_" + std::to_string(::getpid()) + ".sock";
+    std::string err;
+    struct stat st;
+    {
+        ConfigServer server;
+        ASSERT_TRUE(server.listen(path, err)) << "Error: " << err;
+        ASSERT_EQ(::stat(path.c_str(), &st), 0);
+        EXPECT_EQ(st.st_mode & 0777, 0600u);
+    }
+    {
+        ConfigServer server;
+        ASSERT_TRUE(server.listen(path, err, 0660)) << "Error: " << err;
+        ASSERT_EQ(::stat(path.c_str(), &st), 0);
+        EXPECT_EQ(st.st_mode & 0777, 0660u);
+    }
+    EXPECT_NE(::stat(path.c_str(), &st), 0);
+}
+
+// Test that pipelined requests are answered in order
+TEST_F(ServerFixture, Pipelining) {
+    ConfigClient client;
+    std::string err;
+    ASSERT_TRUE(client.connect(path_, err)) << "Error: " << err;
+
+    std::vector<uint32_t> ids(50);
+    for (auto &id : ids) ASSERT_TRUE(client.send({{"section1", "host"}}, id, err)) << "Error: " << err;
+    for (uint32_t expected : ids) {
+        uint32_t id = 0;
+        ConfigClient::Values values;
+        ASSERT_TRUE(client.receive(id, values, err)) << "Error: " << err;
+        EXPECT_EQ(id, expected);
+        ASSERT_EQ(values.size(), 1u);
+        EXPECT_EQ(values[0].value_or(""), "localhost");
+    }
+}
+
+// Test that subscribers are told about publishes and see the new values
+TEST_F(ServerFixture, SubscribeToReloads) {
+    ConfigClient client;
+    std::string err;
+    ASSERT_TRUE(client.connect(path_, err)) << "Error: " << err;
+    ASSERT_TRUE(client.subscribe(err)) << "Error: " << err;
+    EXPECT_EQ(client.generation(), 1u);
+
+    uint64_t generation = 0;
+    EXPECT_FALSE(client.waitReload(generation, err, 10));
+    EXPECT_TRUE(err.empty());
+
+    Config config;
+    config.set("section1", "host", "example.org");
+    ASSERT_TRUE(server_.publish(config, err)) << "Error: " << err;
+    ASSERT_TRUE(client.waitReload(generation, err, 5000)) << "Error: " << err;
+    EXPECT_EQ(generation, 2u);
+    EXPECT_EQ(client.get("section1", "host"), "example.org");
+    EXPECT_EQ(client.get("section1", "port", "gone"), "gone");
+}
+
+// Test that a client sending garbage is disconnected without affecting others
+TEST_F(ServerFixture, BadFrameClosesConnection) {
+    ConfigClient good;
+    std::string err;
+    ASSERT_TRUE(good.connect(path_, err)) << "Error: " << err;
+
+    ConfigClient bad;
+    ASSERT_TRUE(bad.connect(path_, err)) << "Error: " << err;
+    ConfigClient::Values values;
+    EXPECT_FALSE(bad.get({{std::string(17u << 20, 'x'), "key"}}, values, err));
+
+    EXPECT_EQ(good.get("section1", "host"), "localhost");
+}
@@ -0,0 +1,118 @@
+#include <iniparsercxx_shm.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Segment name unique to this test process
+static std::string shmName(const char *test) {
+    return "/iniparsercxx-test-" + std::to_string(::getpid()) + "-" + test;
+}
+
+// Permission bits of a shared memory object, -1 if it does not exist
+static int shmMode(const std::string &name) {
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return -1;
+    struct stat st;
+    int mode = ::fstat(fd, &st) == 0 ? static_cast<int>(st.st_mode & 0777) : -1;
+    ::close(fd);
+    return mode;
+}
+
+// Test that a reader sees what was published
+TEST(SharedConfigTest, PublishAndRead) {
+    std::string name = shmName("read");
+    SharedConfigPublisher::remove(name);
+
+    Config config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+    SharedConfigPublisher publisher(name);
+    ASSERT_TRUE(publisher.publish(config, err)) << "Error: " << err;
+    EXPECT_EQ(publisher.generation(), 1u);
+
+    SharedConfigReader reader(name);
+    ASSERT_TRUE(reader.attach(err)) << "Error: " << err;
+    EXPECT_EQ(reader.generation(), 1u);
+    EXPECT_EQ(reader.get("section1", "host"), "localhost");
+    EXPECT_EQ(reader.get("section1", "nokey", "default"), "default");
+
+    SharedConfigPublisher::remove(name);
+}
+
+// Test that readers switch to a new generation on their next lookup
+TEST(SharedConfigTest, ReaderFollowsUpdates) {
+    std::string name = shmName("update");
+    SharedConfigPublisher::remove(name);
+
+    std::string err;
+    Config config;
+    config.set("app", "mode", "blue");
+    SharedConfigPublisher publisher(name);
+    ASSERT_TRUE(publisher.publish(config, err)) << "Error: " << err;
+
+    SharedConfigReader reader(name);
+    ASSERT_TRUE(reader.attach(err)) << "Error: " << err;
+    std::string_view value;
+    ASSERT_TRUE(reader.find("app", "mode", value));
+    EXPECT_EQ(value, "blue");
+
+    for (int i = 0; i < 5; ++i) {
+        config.set("app", "mode", "green" + std::to_string(i));
+        ASSERT_TRUE(publisher.publish(config, err)) << "Error: " << err;
+        EXPECT_EQ(reader.get("app", "mode"), "green" + std::to_string(i));
+    }
+    EXPECT_EQ(reader.generation(), 6u);
+    EXPECT_FALSE(reader.refresh());
+
+    // a restarted publisher continues the generation sequence
+    SharedConfigPublisher restarted(name);
+    config.set("app", "mode", "red");
+    ASSERT_TRUE(restarted.publish(config, err)) << "Error: " << err;
+    EXPECT_EQ(restarted.generation(), 7u);
+    EXPECT_EQ(reader.get("app", "mode"), "red");
+
+    SharedConfigPublisher::remove(name);
+}
+
+// Test attaching before anything is published
+TEST(SharedConfigTest, AttachWithoutPublisher) {
+    std::string name = shmName("none");
+    SharedConfigPublisher::remove(name);
+    SharedConfigReader reader(name);
+    std::string err;
+    EXPECT_FALSE(reader.attach(err));
+    EXPECT_FALSE(err.empty());
+    EXPECT_EQ(reader.get("app", "mode", "default"), "default");
+}
+
+// Test that segments are private by default and take the publisher's mode
+TEST(SharedConfigTest, SegmentMode) {
+    Config config;
+    std::string err;
+    ASSERT_TRUE(config.loadFromFile("test_valid.ini", err)) << "Error: " << err;
+
+    std::string name = shmName("mode");
+    SharedConfigPublisher::remove(name);
+    {
+        SharedConfigPublisher publisher(name);
+        ASSERT_TRUE(publisher.publish(config, err)) << "Error: " << err;
+        EXPECT_EQ(shmMode(name), 0600);
+        EXPECT_EQ(shmMode(name + ".1"), 0600);
+    }
+    SharedConfigPublisher::remove(name);
+
+    mode_t old = ::umask(077);
+    {
+        SharedConfigPublisher publisher(name, 0644);
+        ASSERT_TRUE(publisher.publish(config, err)) << "Error: " << err;
+        EXPECT_EQ(shmMode(name), 0644);
+        EXPECT_EQ(shmMode(name + ".1"), 0644);
+    }
+    ::umask(old);
+    SharedConfigPublisher::remove(name);
+}
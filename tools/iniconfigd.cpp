@@ -0,0 +1,62 @@
+// iniconfigd - serve an INI file to local processes over a Unix socket.
+//
+// Usage: iniconfigd <config.ini> <socket path>
+// SIGHUP reloads the file; a file that fails to load keeps the previous config.
+// SIGINT and SIGTERM stop the daemon.
+
+#include <iniparsercxx_server.hpp>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <config.ini> <socket path>\n", argv[0]);
+        return 2;
+    }
+    const std::string path = argv[1];
+
+    // Signals are handled by a dedicated thread with sigwait, so reloading
+    // never runs inside a signal handler.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    ConfigServer server;
+    std::string err;
+    Config cfg;
+    if (!cfg.loadFromFile(path, err) || !server.publish(cfg, err) || !server.listen(argv[2], err)) {
+        std::fprintf(stderr, "iniconfigd: %s\n", err.c_str());
+        return 1;
+    }
+
+    std::thread handler([&] {
+        for (;;) {
+            int sig = 0;
+            if (sigwait(&signals, &sig) != 0) continue;
+            if (sig != SIGHUP) break;
+            Config next;
+            std::string reload_err;
+            if (next.loadFromFile(path, reload_err) && server.publish(next, reload_err))
+                std::fprintf(stderr, "iniconfigd: reloaded %s (generation %llu)\n", path.c_str(),
+                             static_cast<unsigned long long>(server.generation()));
+            else
+                std::fprintf(stderr, "iniconfigd: reload failed: %s\n", reload_err.c_str());
+        }
+        server.stop();
+    });
+
+    bool ok = server.run(err);
+    if (!ok) {
+        std::fprintf(stderr, "iniconfigd: %s\n", err.c_str());
+        pthread_kill(handler.native_handle(), SIGTERM);
+    }
+    handler.join();
+    return ok ? 0 : 1;
+}